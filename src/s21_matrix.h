@@ -4,14 +4,53 @@
 #define OK 0
 #define ERR_FAIL 1
 #define ERR_CALC 2
+#define ERR_CANCEL 3
+
+// one data block with row pointers into it, zeroed by the worker threads
+// (pinned with S21_AFFINITY_SPREAD) so pages land on their NUMA nodes
+#define S21_ALLOC_DEFAULT 0
+#define S21_ALLOC_CONTIGUOUS 1
+#define S21_ALLOC_FIRST_TOUCH 2
+// rows start on 64-byte lines, padded off 4K strides; HUGE also advises
+// transparent huge pages for blocks of at least S21_HUGE_THRESHOLD bytes
+#define S21_ALLOC_ALIGNED 4
+#define S21_ALLOC_HUGE 8
+#define S21_ALLOC_MASK 0xff  // any other bit is refused (ERR_FAIL)
+// state bits: a view borrows its rows from another matrix; a frozen
+// matrix (and every view of it) is read-only from then on
+#define S21_M_VIEW 0x100
+#define S21_M_FROZEN 0x200
+
+// s21_wrap_matrix: who frees the external buffer
+#define S21_WRAP_BORROW 0
+#define S21_WRAP_OWN 1
+
+// s21_mult_matrix_ex accumulation: pairwise sums over k blocks, or Dot2
+// (error-free products and sums, about twice the working precision)
+#define S21_ACC_FAST 0
+#define S21_ACC_PAIRWISE 1
+#define S21_ACC_DOT2 2
+
+#define S21_AFFINITY_NONE 0
+#define S21_AFFINITY_SPREAD 1
 
 #define SUCCESS 1
 #define FAILURE 0
 #define EPS 1e7
+#define S21_MAX_NODES 64
+#define S21_ALIGN 64
+#define S21_ALIAS_STRIDE 4096
+#define S21_HUGE_PAGE (2 << 20)
+#define S21_HUGE_THRESHOLD S21_HUGE_PAGE
+#define S21_STREAM_DEPTH 2
+#define S21_ASYNC_MAX_THREADS 64
+#define S21_ASYNC_BATCH 8
+#define S21_ASYNC_AGING 16
 
 // #include <stdio.h>
 #include <limits.h>
 #include <math.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 
 extern double round(double x);
@@ -20,6 +59,16 @@ extern double round(double x);
 #define is_nan(x) __builtin_isnan(x)
 #define is_inf(x) __builtin_isinf(x)
 
+// one clone per x86-64 level, the ifunc resolver picks one at load time
+#if defined(S21_MULTIVERSION) && defined(__x86_64__) && defined(__linux__)
+#define S21_HAVE_CLONES 1
+#define S21_CLONES                                                \
+  __attribute__((target_clones("default", "arch=x86-64-v2",       \
+                               "arch=x86-64-v3", "arch=x86-64-v4")))
+#else
+#define S21_CLONES
+#endif
+
 #define FOR(x) for (int i = 0; i < x; i++)
 #define FORS(x, y) FOR(x) for (int j = 0; j < y; j++)
 #define FORSZ(x, y, z) FORS(x, y) for (int k = 0; k < z; k++)
@@ -28,6 +77,11 @@ typedef struct matrix_struct {
   double **matrix;
   int rows;
   int columns;
+  int flags;      // S21_ALLOC_* layout the matrix was created with
+  double *block;  // single data buffer of non-default layouts, else NULL
+  int ld;         // row stride in doubles within block, 0 for separate rows
+  // handle count of cloned data, NULL until the first clone installs it
+  _Atomic(struct s21_share *) share;
 } matrix_t;
 
 #define M_A matrix_t *A
@@ -40,9 +94,37 @@ typedef struct matrix_struct {
 // SUPPLEMENTARY ||
 int s21_m_valid(M_A);
 int s21_m_eqdim(M_AB);
+int s21_check_square(M_A);
+int s21_alloc_block(int rows, int columns, int flags, matrix_t *result);
+int s21_share_release(M_A);
 
 // BASIC ||
 int s21_create_matrix(int rows, int columns, matrix_t *result);
+int s21_create_matrix_ex(int rows, int columns, int flags, matrix_t *result);
+// matrix over caller memory, row i at data + i * stride (0: columns);
+// S21_WRAP_OWN hands data (from malloc) over to s21_remove_matrix
+int s21_wrap_matrix(double *data, int rows, int columns, int stride,
+                    int ownership, matrix_t *result);
+// rows x columns window at (row, column) of A, no data is copied
+int s21_matrix_view(M_A, int row, int column, int rows, int columns,
+                    matrix_t *result);
+// marks A read-only for good: writers refuse it, readers on any number of
+// threads need no lock; s21_remove_matrix once they have all finished
+int s21_freeze(M_A);
+int s21_is_frozen(M_A);
+// copy-on-write: the clone shares A's rows until s21_detach_matrix, which
+// copies them only while other handles (or a freeze) still hold them;
+// each handle is s21_remove_matrix'd, the last one frees the data. Views
+// and borrowed wraps are copied at once, and writes through a view of a
+// shared matrix reach every handle. Cloning writes A: the first clone
+// installs A's share count with a compare-exchange on the atomic share
+// field, later ones bump that count; A is otherwise only read. Any number
+// of threads may clone one matrix (frozen ones too) at once, but A must
+// not be detached or removed meanwhile. Each clone is a handle of its
+// own, detached and removed by the thread holding it
+int s21_clone_matrix(M_ARES);
+int s21_detach_matrix(M_A);
+int s21_share_count(M_A);
 void s21_remove_matrix(M_A);
 int s21_eq_matrix(M_AB);
 
@@ -51,13 +133,310 @@ int s21_sum_matrix(M_ABRES);
 int s21_sub_matrix(M_ABRES);
 int s21_mult_number(M_ANRES);
 int s21_mult_matrix(M_ABRES);
+int s21_mult_matrix_ex(M_ABRES, int accumulate);
+
+// CANCELLATION || long operations poll the token between blocks of work
+// and return ERR_CANCEL with all scratch freed once it fires
+typedef struct {
+  atomic_int cancelled;
+  double deadline;  // CLOCK_MONOTONIC seconds, 0 for none
+} s21_cancel_t;
+
+void s21_cancel_init(s21_cancel_t *token, double timeout_seconds);
+void s21_cancel(s21_cancel_t *token);
+int s21_cancelled(s21_cancel_t *token);
 
 // MISCELLANEOUS ||
 int s21_transpose(M_ARES);
 int s21_inverse_matrix(M_ARES);
 int s21_calc_complements(M_ARES);
 int s21_determinant(M_ADRES);
+int s21_determinant_ex(M_ADRES, s21_cancel_t *token);
+int s21_calc_complements_ex(M_ARES, s21_cancel_t *token);
+int s21_inverse_matrix_ex(M_ARES, s21_cancel_t *token);
 
 matrix_t *s21_create_minor(int ex_rows, int ex_columns, matrix_t *A);
+// same cofactor expansion spread over threads (<= 0 picks online CPUs)
+int s21_determinant_mt(M_ADRES, int threads, s21_cancel_t *token);
+int s21_calc_complements_mt(M_ARES, int threads, s21_cancel_t *token);
+
+// POWERS || A^k by repeated squaring (k < 0 inverts first), e^A by
+// scaling and squaring of a Pade approximant; both ping-pong two buffers
+int s21_matrix_pow(matrix_t *A, long long k, matrix_t *result);
+int s21_matrix_exp(M_ARES);
+
+// VECTORS || contiguous storage on S21_ALIGN; s21_gemv computes
+// y = alpha * op(A) * x + beta * y, op(A) = A or A^T (beta 0 ignores y)
+#define S21_NO_TRANS 0
+#define S21_TRANS 1
+
+typedef struct {
+  double *data;
+  int size;
+} s21_vector_t;
+
+int s21_create_vector(int size, s21_vector_t *result);
+void s21_remove_vector(s21_vector_t *v);
+int s21_gemv(int trans, double alpha, matrix_t *A, s21_vector_t *x,
+             double beta, s21_vector_t *y);
+
+// REDUCTIONS || partials per fixed chunk of rows, combined in chunk order:
+// bit-identical for any thread count; s21_min_max skips NaN
+#define S21_NORM_1 0    // largest column sum of |a_ij|
+#define S21_NORM_INF 1  // largest row sum of |a_ij|
+#define S21_NORM_FRO 2
+#define S21_NORM_MAX 3  // largest |a_ij|
+
+int s21_norm(matrix_t *A, int kind, double *result);
+int s21_trace(M_ADRES);
+int s21_row_sums(matrix_t *A, s21_vector_t *result);
+int s21_column_sums(matrix_t *A, s21_vector_t *result);
+int s21_min_max(matrix_t *A, double *min, double *max);
+
+// PRODUCTS || element-wise (Hadamard) product and quotient of equal
+// shapes, x y^T, and A (x) B; s21_kron_apply computes y = (A (x) B) x
+// through A X B^T (x read row-major as X) without forming A (x) B
+int s21_hadamard(M_ABRES);
+int s21_hadamard_div(M_ABRES);
+int s21_outer(s21_vector_t *x, s21_vector_t *y, matrix_t *result);
+int s21_kron(M_ABRES);
+int s21_kron_apply(M_AB, s21_vector_t *x, s21_vector_t *y);
+
+// STRUCTURED || compact bands: row i stores columns max(0, i - kl) to
+// min(n - 1, i + ku); triangular matrices are the bands with kl or ku 0
+#define S21_UPPER 0
+#define S21_LOWER 1
+
+typedef struct {
+  double **row;  // row[i] starts at column max(0, i - kl)
+  double *data;
+  int n, kl, ku;
+} s21_band_t;
+
+int s21_create_band(int n, int kl, int ku, s21_band_t *result);
+int s21_create_triangular(int n, int uplo, s21_band_t *result);
+void s21_remove_band(s21_band_t *B);
+double *s21_band_at(s21_band_t *B, int i, int j);
+int s21_band_from_matrix(matrix_t *A, int kl, int ku, s21_band_t *result);
+int s21_band_to_matrix(s21_band_t *B, matrix_t *result);
+int s21_matrix_bandwidth(matrix_t *A, int *kl, int *ku);
+int s21_band_mult(s21_band_t *B, matrix_t *X, matrix_t *result);
+int s21_band_solve(s21_band_t *B, matrix_t *X, matrix_t *result);
+int s21_band_determinant(s21_band_t *B, double *result);
+
+// DECOMPOSITIONS ||
+// Cholesky routines refuse (ERR_CALC) an A that is not symmetric up to
+// rounding, then read its lower triangle; L is a compact lower triangle
+int s21_cholesky(matrix_t *A, s21_band_t *L);
+int s21_cholesky_solve(s21_band_t *L, matrix_t *B, matrix_t *result);
+int s21_spd_inverse(M_ARES);
+int s21_spd_logdet(M_ADRES);
+// Householder QR of an m x n (m >= n) matrix: thin Q (m x n), R (n x n)
+int s21_qr(matrix_t *A, matrix_t *Q, matrix_t *R);
+int s21_lstsq(M_ABRES);
+int s21_lu_determinant(M_ADRES);
+int s21_lu_inverse(M_ARES);
+int s21_lu_solve(M_ABRES);
+// ||A||_1 ||A^-1||_1 with ||A^-1||_1 estimated from the LU factors
+// (Hager-Higham), inf for an exactly singular A
+int s21_cond_estimate(M_ADRES);
+
+// SPECTRAL || symmetric A (lower triangle read): eigenvalues ascending,
+// eigenvectors as the matching columns of vectors (NULL skips them)
+int s21_eigen_sym(matrix_t *A, s21_vector_t *values, matrix_t *vectors);
+// thin A = U diag(S) V^T, k = min(m, n) triplets with S descending; U, V
+// may be NULL, their columns for S = 0 are left zero
+int s21_svd(matrix_t *A, matrix_t *U, s21_vector_t *S, matrix_t *V);
+// Moore-Penrose inverse dropping S <= tol, tol < 0: max(m, n) eps S_max
+int s21_pinv(matrix_t *A, double tol, matrix_t *result);
+// leading k triplets from a randomized range finder (fixed seed)
+int s21_svd_top(matrix_t *A, int k, matrix_t *U, s21_vector_t *S,
+                matrix_t *V);
+
+// TEXT I/O || CSV (one row per line) and Matrix Market array/coordinate
+// (real, integer or pattern; general, symmetric or skew-symmetric) in,
+// the shortest round-trip decimal out; a Matrix Market banner selects
+// the format on load
+#define S21_FMT_CSV 0
+#define S21_FMT_MM_ARRAY 1
+#define S21_FMT_MM_COORD 2
+
+int s21_parse_matrix(const char *text, matrix_t *result);
+int s21_load_matrix(const char *path, matrix_t *result);
+int s21_save_matrix(const char *path, matrix_t *A, int format);
+
+// THREADING || every entry point is reentrant: all working state lives
+// in its own stack and heap, and the process-wide tuning, statistics,
+// topology and async pool sit behind locks, atomics or pthread_once.
+// Inputs are only read, so one matrix can be an input on many threads at
+// once; a matrix some thread writes (a result, a stream cursor) belongs
+// to that thread alone. s21_freeze states the first case in the data
+typedef void (*s21_task_fn)(void *ctx, int task, int tid);
+int s21_thread_count(int requested, int tasks);
+int s21_parallel_for(int tasks, int threads, s21_task_fn fn, void *ctx);
+// exactly one task per thread, task == tid: stable row-band ownership
+int s21_parallel_static(int threads, s21_task_fn fn, void *ctx);
+int s21_numa_nodes(void);
+void s21_set_thread_affinity(int mode);
+
+// STREAMING || row chunks flow reader -> kernel -> writer, O(chunk) memory
+// readers return the rows stored (0 at the end, < 0 on error),
+// writers return OK or an error code
+typedef int (*s21_row_reader)(void *ctx, double *rows, int max_rows,
+                              int columns);
+typedef int (*s21_row_writer)(void *ctx, const double *rows, int count,
+                              int columns);
+typedef struct {
+  s21_row_reader read;
+  void *ctx;
+} s21_source_t;
+typedef struct {
+  s21_row_writer write;
+  void *ctx;
+} s21_sink_t;
+typedef struct {
+  matrix_t *m;
+  int row;
+} s21_cursor_t;
+
+int s21_stream_sum(s21_source_t *A, s21_source_t *B, int columns,
+                   s21_sink_t out, int chunk_rows);
+int s21_stream_sub(s21_source_t *A, s21_source_t *B, int columns,
+                   s21_sink_t out, int chunk_rows);
+int s21_stream_mult_number(s21_source_t *A, double number, int columns,
+                           s21_sink_t out, int chunk_rows);
+int s21_matrix_reader(void *ctx, double *rows, int max_rows, int columns);
+int s21_matrix_writer(void *ctx, const double *rows, int count, int columns);
+int s21_file_reader(void *ctx, double *rows, int max_rows, int columns);
+int s21_file_writer(void *ctx, const double *rows, int count, int columns);
+
+// ASYNC || jobs run on an internal pool, small jobs first (with aging);
+// A, B and result must stay alive until the future completes;
+// s21_future_poll is 1 once done, 0 before, -1 for NULL
+typedef struct s21_future s21_future_t;
+typedef void (*s21_callback_t)(int status, void *arg);
+
+s21_future_t *s21_async_mult_matrix(M_ABRES);
+s21_future_t *s21_async_inverse_matrix(M_ARES);
+int s21_future_poll(s21_future_t *f);
+int s21_future_wait(s21_future_t *f);
+int s21_future_then(s21_future_t *f, s21_callback_t cb, void *arg);
+void s21_future_free(s21_future_t *f);
+void s21_async_shutdown(void);
+
+// INSTRUMENTATION || counters are compiled in by make STATS=1 (-DS21_STATS)
+typedef enum {
+  S21_OP_CREATE,
+  S21_OP_SUM,
+  S21_OP_SUB,
+  S21_OP_MULT_NUMBER,
+  S21_OP_MULT,
+  S21_OP_TRANSPOSE,
+  S21_OP_DETERMINANT,
+  S21_OP_COMPLEMENTS,
+  S21_OP_INVERSE,
+  S21_OP_CHOLESKY,
+  S21_OP_CHOLESKY_SOLVE,
+  S21_OP_QR,
+  S21_OP_LSTSQ,
+  S21_OP_POW,
+  S21_OP_EXP,
+  S21_OP_GEMV,
+  S21_OP_REDUCE,
+  S21_OP_COND,
+  S21_OP_EIGEN,
+  S21_OP_SVD,
+  S21_OP_IO,
+  S21_OP_HADAMARD,
+  S21_OP_KRON,
+  S21_OP_COUNT
+} s21_op_t;
+
+typedef struct {
+  unsigned long long calls, flops, nanos;
+} s21_op_stats_t;
+
+typedef struct {
+  s21_op_stats_t ops[S21_OP_COUNT];
+  unsigned long long bytes_total;
+  long long bytes_live, bytes_peak;
+} s21_stats_t;
+
+void s21_stats_snapshot(s21_stats_t *out);
+void s21_stats_reset(void);
+int s21_stats_json(char *buf, size_t size);
+const char *s21_op_name(s21_op_t op);
+
+
+#ifdef S21_STATS
+typedef struct {
+  s21_op_t op;
+  int outer;
+  unsigned long long start;
+} s21_stat_scope_t;
+
+void s21_stat_enter(s21_stat_scope_t *s, s21_op_t op, double flops);
+void s21_stat_leave(s21_stat_scope_t *s);
+void s21_stat_bytes(long long bytes);
+
+// scope guard: the cleanup runs on every return path of the function
+#define S21_STAT(op, flops)                                            \
+  s21_stat_scope_t s21_scope __attribute__((cleanup(s21_stat_leave))); \
+  s21_stat_enter(&s21_scope, op, flops)
+#define S21_STAT_BYTES(bytes) s21_stat_bytes(bytes)
+#else
+#define S21_STAT(op, flops)
+#define S21_STAT_BYTES(bytes) (void)0
+#endif
+
+// PLANNER || entry points ask s21_plan which kernel to run; the thresholds
+// are process-wide and can be loaded from a key=value profile file.
+// Cholesky, LU, the band routines and s21_cond_estimate have one serial
+// kernel each and no choice to make; their plans only price async jobs
+// (S21_MATRIX_PROFILE, else the make autotune cache, is read on first use)
+typedef enum {
+  S21_ALGO_NAIVE,
+  S21_ALGO_SMALL,
+  S21_ALGO_BLOCKED,
+  S21_ALGO_THREADED,
+  S21_ALGO_STRASSEN,
+  S21_ALGO_COFACTOR,
+  S21_ALGO_LU,
+  S21_ALGO_TRIANGULAR
+} s21_algo_t;
+
+typedef struct {
+  s21_op_t op;
+  s21_algo_t algo;
+  double flops, bytes, scratch;  // estimates, scratch is peak extra bytes
+  int threads, block, accumulate;
+} s21_plan_t;
+
+typedef struct {
+  int small_max;          // every dimension <= small_max: plain triple loop
+  int block;              // tile edge of the blocked multiply
+  int transpose_block;    // tile edge of the blocked transpose
+  double threaded_flops;  // work from which threads pay off
+  int threads;            // 0: online CPUs
+  int strassen_min;       // every multiply dimension >= strassen_min
+  int strassen_leaf;      // recursion stops at this edge
+  int complements_mt_min;
+  int accumulate;  // S21_ACC_* of s21_mult_matrix
+  int qr_block;    // Householder QR panel width
+} s21_tuning_t;
+
+int s21_plan(s21_op_t op, matrix_t *A, matrix_t *B, s21_plan_t *plan);
+int s21_plan_ex(s21_op_t op, matrix_t *A, matrix_t *B,
+                const s21_tuning_t *tuning, s21_plan_t *plan);
+const char *s21_algo_name(s21_algo_t algo);
+// cofactor expansion of an n x n determinant, scratch gets its minor bytes
+double s21_expansion_flops(int n, double *scratch);
+void s21_tuning_get(s21_tuning_t *out);
+void s21_tuning_set(const s21_tuning_t *in);
+void s21_tuning_defaults(s21_tuning_t *out);
+int s21_tuning_load(const char *path);
+int s21_tuning_save(const char *path);
+int s21_tuning_path(char *buf, size_t size);
+int s21_gemm(const s21_plan_t *plan, M_ABRES);
 
 #endif  // MATRIX_21
\ No newline at end of file
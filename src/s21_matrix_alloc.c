@@ -0,0 +1,167 @@
+#define _GNU_SOURCE
+#include <string.h>
+#include <sys/mman.h>
+
+#include "s21_matrix.h"
+
+#define PADDED (S21_ALLOC_ALIGNED | S21_ALLOC_HUGE)
+#define LINE (S21_ALIGN / sizeof(double))
+
+//===================   ALLOCATION   =======================
+
+typedef struct {
+  double *block;
+  size_t ld;
+  int rows, threads;
+} s21_touch_t;
+
+// each worker zeroes, and so first-touches, the row band it will own
+static void s21_touch_band(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_touch_t *t = ctx;
+  size_t r0 = (size_t)t->rows * task / t->threads;
+  size_t r1 = (size_t)t->rows * (task + 1) / t->threads;
+  memset(t->block + r0 * t->ld, 0, (r1 - r0) * t->ld * sizeof(double));
+}
+
+// rows padded to whole cache lines, and one line more on a 4K stride
+// where every row would map onto the same L1 sets
+static size_t s21_leading_dim(int columns, int flags) {
+  size_t ld = columns;
+  if (!(flags & PADDED)) return ld;
+  ld = (ld + LINE - 1) / LINE * LINE;
+  if (ld * sizeof(double) % S21_ALIAS_STRIDE == 0) ld += LINE;
+  return ld;
+}
+
+static double *s21_alloc_data(size_t *size, int flags) {
+  size_t align = flags & PADDED ? S21_ALIGN : 0;
+  if (flags & S21_ALLOC_HUGE && *size >= S21_HUGE_THRESHOLD)
+    align = S21_HUGE_PAGE;
+  if (!align) return malloc(*size);  // untouched pages until the first write
+
+  *size = (*size + align - 1) / align * align;
+  double *data = aligned_alloc(align, *size);
+#ifdef MADV_HUGEPAGE
+  if (data && align == S21_HUGE_PAGE) madvise(data, *size, MADV_HUGEPAGE);
+#endif
+  return data;
+}
+
+int s21_alloc_block(int rows, int columns, int flags, matrix_t *result) {
+  if (flags & ~S21_ALLOC_MASK) return ERR_FAIL;  // no view or frozen bits
+  size_t ld = s21_leading_dim(columns, flags);
+  size_t size = (size_t)rows * ld * sizeof(double);
+  result->matrix = calloc(rows, sizeof(double *));
+  result->block = s21_alloc_data(&size, flags);
+  if (!result->matrix || !result->block)
+    return free(result->matrix), free(result->block), result->matrix = NULL,
+           result->block = NULL, ERR_FAIL;
+
+  s21_touch_t touch = {result->block, ld, rows, 1};
+  if (flags & S21_ALLOC_FIRST_TOUCH)
+    touch.threads = s21_thread_count(0, rows);
+  if (touch.threads < 2 ||
+      s21_parallel_static(touch.threads, s21_touch_band, &touch))
+    memset(result->block, 0, size);
+
+  FOR(rows) result->matrix[i] = result->block + i * ld;
+  result->rows = rows, result->columns = columns, result->flags = flags;
+  result->ld = (int)ld, result->share = NULL;
+  return OK;
+}
+
+// only the row pointer array is allocated; A must outlive the view
+int s21_matrix_view(M_A, int row, int column, int rows, int columns,
+                    matrix_t *result) {
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (rows <= 0 || columns <= 0 || row < 0 || column < 0) return ERR_CALC;
+  if (row + rows > A->rows || column + columns > A->columns) return ERR_CALC;
+  double **rp = malloc(sizeof(double *) * rows);
+  if (!rp) return ERR_FAIL;
+  FOR(rows) rp[i] = A->matrix[row + i] + column;
+  *result = (matrix_t){.matrix = rp, .rows = rows, .columns = columns,
+                       .flags = A->flags | S21_M_VIEW, .block = A->block,
+                       .ld = A->ld};
+  return OK;
+}
+
+// one-way: the library never writes a frozen matrix or its views again
+int s21_freeze(M_A) {
+  if (!s21_m_valid(A)) return ERR_FAIL;
+  A->flags |= S21_M_FROZEN;
+  return OK;
+}
+
+int s21_is_frozen(M_A) { return !!A && !!(A->flags & S21_M_FROZEN); }
+
+//====================   SHARING   =========================
+
+struct s21_share {
+  atomic_int refs;
+};
+
+// a private copy in A's layout, neither view nor frozen
+static int s21_copy_matrix(M_ARES) {
+  matrix_t copy;
+  int layout = A->flags & S21_ALLOC_MASK;
+  if (s21_create_matrix_ex(A->rows, A->columns, layout, &copy)) return ERR_FAIL;
+  size_t bytes = sizeof(double) * A->columns;
+  FOR(A->rows) memcpy(copy.matrix[i], A->matrix[i], bytes);
+  *result = copy;
+  return OK;
+}
+
+// the first clone installs the count; when clones race for it, one
+// compare-exchange wins and the others drop theirs and take the winner's
+int s21_clone_matrix(M_ARES) {
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (A->flags & S21_M_VIEW) return s21_copy_matrix(A, result);
+  struct s21_share *share = atomic_load(&A->share);
+  if (!share) {
+    struct s21_share *fresh = malloc(sizeof(struct s21_share));
+    if (!fresh) return ERR_FAIL;
+    atomic_init(&fresh->refs, 1);
+    if (atomic_compare_exchange_strong(&A->share, &share, fresh))
+      share = fresh;
+    else
+      free(fresh);
+  }
+  atomic_fetch_add_explicit(&share->refs, 1, memory_order_relaxed);
+  *result = (matrix_t){.matrix = A->matrix, .rows = A->rows,
+                       .columns = A->columns, .flags = A->flags,
+                       .block = A->block, .ld = A->ld};
+  atomic_init(&result->share, share);
+  return OK;
+}
+
+// drops A's handle; 1 when it was the last and the data is A's to free
+int s21_share_release(M_A) {
+  struct s21_share *share = A->share;
+  A->share = NULL;
+  if (atomic_fetch_sub_explicit(&share->refs, 1, memory_order_acq_rel) > 1)
+    return A->matrix = NULL, A->block = NULL, 0;
+  free(share);
+  return 1;
+}
+
+// the last handle keeps the rows it has, anything else gets its own copy
+int s21_detach_matrix(M_A) {
+  if (!s21_m_valid(A)) return ERR_FAIL;
+  int shared = A->share && atomic_load_explicit(&A->share->refs,
+                                                memory_order_acquire) > 1;
+  if (!shared && !(A->flags & S21_M_FROZEN)) {
+    if (A->share) s21_share_release(A);
+    return OK;
+  }
+  matrix_t copy;
+  if (s21_copy_matrix(A, &copy)) return ERR_FAIL;
+  s21_remove_matrix(A);
+  *A = copy;
+  return OK;
+}
+
+int s21_share_count(M_A) {
+  if (!s21_m_valid(A)) return 0;
+  return A->share ? atomic_load(&A->share->refs) : 1;
+}
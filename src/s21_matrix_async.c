@@ -0,0 +1,207 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+
+#include "s21_matrix.h"
+
+//=====================   ASYNC   ==========================
+
+enum { S21_JOB_MULT, S21_JOB_INVERSE };
+
+struct s21_future {
+  matrix_t *A, *B, *result;
+  int op, status, done, bucket;
+  unsigned long seq;
+  s21_callback_t cb;
+  void *cb_arg;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  struct s21_future *next;  // pending queue link
+};
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t *workers;
+  int threads, idle, stop;
+  unsigned long seq;
+  s21_future_t *pending;
+} s21_scheduler_t;
+
+static s21_scheduler_t s21_sched = {.lock = PTHREAD_MUTEX_INITIALIZER,
+                                    .cond = PTHREAD_COND_INITIALIZER};
+
+// smaller size classes first; every S21_ASYNC_AGING newer submissions
+// promote a waiting job by one class so large jobs never starve
+static int s21_job_rank(s21_future_t *f) {
+  return f->bucket - (int)((s21_sched.seq - f->seq) / S21_ASYNC_AGING);
+}
+
+// unlinks jobs of the best rank in FIFO order: that rank's fair share
+// among this worker and the idle ones, at least 1, at most S21_ASYNC_BATCH
+static int s21_take_batch(s21_future_t **batch) {
+  s21_future_t *best = NULL;
+  for (s21_future_t *f = s21_sched.pending; f; f = f->next)
+    if (!best || s21_job_rank(f) < s21_job_rank(best)) best = f;
+  if (!best) return 0;
+  int n = 0, rank = s21_job_rank(best), same = 0;
+  for (s21_future_t *f = s21_sched.pending; f; f = f->next)
+    same += s21_job_rank(f) == rank;
+  int cap = same / (s21_sched.idle + 1);
+  cap = cap < 1 ? 1 : cap > S21_ASYNC_BATCH ? S21_ASYNC_BATCH : cap;
+  for (s21_future_t **p = &s21_sched.pending; *p && n < cap;)
+    if (s21_job_rank(*p) == rank)
+      batch[n++] = *p, *p = (*p)->next;
+    else
+      p = &(*p)->next;
+  return n;
+}
+
+static void s21_job_run(s21_future_t *f) {
+  int status = f->op == S21_JOB_MULT ? s21_mult_matrix(f->A, f->B, f->result)
+                                     : s21_inverse_matrix(f->A, f->result);
+  pthread_mutex_lock(&f->lock);
+  f->status = status, f->done = 1;
+  s21_callback_t cb = f->cb;
+  void *arg = f->cb_arg;
+  pthread_cond_broadcast(&f->cond);
+  pthread_mutex_unlock(&f->lock);
+  if (cb) cb(status, arg);  // f may already be freed by a waiter here
+}
+
+static void *s21_sched_worker(void *unused) {
+  (void)unused;
+  s21_future_t *batch[S21_ASYNC_BATCH];
+  pthread_mutex_lock(&s21_sched.lock);
+  while (1) {
+    int n = s21_take_batch(batch);
+    if (!n && s21_sched.stop) break;
+    if (!n) {
+      s21_sched.idle++;
+      pthread_cond_wait(&s21_sched.cond, &s21_sched.lock);
+      s21_sched.idle--;
+      continue;
+    }
+    if (s21_sched.pending && s21_sched.idle)  // the rest go to the idle
+      pthread_cond_signal(&s21_sched.cond);
+    pthread_mutex_unlock(&s21_sched.lock);
+    FOR(n) s21_job_run(batch[i]);
+    pthread_mutex_lock(&s21_sched.lock);
+  }
+  pthread_mutex_unlock(&s21_sched.lock);
+  return NULL;
+}
+
+// called with the scheduler lock held
+static int s21_sched_start(void) {
+  if (s21_sched.workers) return OK;
+  int threads = s21_thread_count(0, S21_ASYNC_MAX_THREADS);
+  s21_sched.workers = calloc(threads, sizeof(pthread_t));
+  if (!s21_sched.workers) return ERR_FAIL;
+  s21_sched.stop = 0, s21_sched.threads = 0;
+  FOR(threads) {  // started threads only, packed from the front
+    pthread_t *slot = &s21_sched.workers[s21_sched.threads];
+    if (!pthread_create(slot, NULL, s21_sched_worker, NULL))
+      s21_sched.threads++;
+  }
+  if (s21_sched.threads) return OK;
+  free(s21_sched.workers), s21_sched.workers = NULL;
+  return ERR_FAIL;
+}
+
+static void s21_future_destroy(s21_future_t *f) {
+  pthread_cond_destroy(&f->cond);
+  pthread_mutex_destroy(&f->lock);
+  free(f);
+}
+
+static s21_future_t *s21_submit(int op, double cost, M_ABRES) {
+  s21_future_t *f = calloc(1, sizeof(s21_future_t));
+  if (!f) return NULL;
+  *f = (s21_future_t){.A = A, .B = B, .result = result, .op = op};
+  f->bucket = cost > 1 ? (int)fmin(log2(cost), 1024) : 0;
+  pthread_mutex_init(&f->lock, NULL);
+  pthread_cond_init(&f->cond, NULL);
+
+  pthread_mutex_lock(&s21_sched.lock);
+  int status = s21_sched.stop && s21_sched.workers ? ERR_FAIL  // shutting down
+                                                   : s21_sched_start();
+  if (!status) {
+    f->seq = s21_sched.seq++;
+    s21_future_t **tail = &s21_sched.pending;
+    while (*tail) tail = &(*tail)->next;
+    *tail = f;
+    pthread_cond_signal(&s21_sched.cond);
+  }
+  pthread_mutex_unlock(&s21_sched.lock);
+  if (status) s21_future_destroy(f), f = NULL;
+  return f;
+}
+
+// the planner's flops for the kernel the job will run, 0 when invalid
+static double s21_job_cost(s21_op_t op, matrix_t *A, matrix_t *B) {
+  s21_plan_t plan;
+  return s21_plan(op, A, B, &plan) ? 0 : plan.flops;
+}
+
+s21_future_t *s21_async_mult_matrix(M_ABRES) {
+  return s21_submit(S21_JOB_MULT, s21_job_cost(S21_OP_MULT, A, B), A, B,
+                    result);
+}
+
+s21_future_t *s21_async_inverse_matrix(M_ARES) {
+  return s21_submit(S21_JOB_INVERSE, s21_job_cost(S21_OP_INVERSE, A, NULL), A,
+                    NULL, result);
+}
+
+int s21_future_poll(s21_future_t *f) {
+  if (!f) return -1;
+  pthread_mutex_lock(&f->lock);
+  int done = f->done;
+  pthread_mutex_unlock(&f->lock);
+  return done;
+}
+
+int s21_future_wait(s21_future_t *f) {
+  if (!f) return ERR_FAIL;
+  pthread_mutex_lock(&f->lock);
+  while (!f->done) pthread_cond_wait(&f->cond, &f->lock);
+  int status = f->status;
+  pthread_mutex_unlock(&f->lock);
+  return status;
+}
+
+// runs cb on the worker when the job completes, or right here if it has
+int s21_future_then(s21_future_t *f, s21_callback_t cb, void *arg) {
+  if (!f || !cb) return ERR_FAIL;
+  pthread_mutex_lock(&f->lock);
+  int done = f->done, status = f->status;
+  if (!done && f->cb) done = -1;
+  if (!done) f->cb = cb, f->cb_arg = arg;
+  pthread_mutex_unlock(&f->lock);
+  if (done < 0) return ERR_CALC;  // one callback per future
+  if (done) cb(status, arg);
+  return OK;
+}
+
+// a queued future cannot be freed, so this waits for completion
+void s21_future_free(s21_future_t *f) {
+  if (!f) return;
+  s21_future_wait(f);
+  s21_future_destroy(f);
+}
+
+// drains the queue and joins the workers, the next submit restarts them
+void s21_async_shutdown(void) {
+  pthread_mutex_lock(&s21_sched.lock);
+  pthread_t *workers = s21_sched.workers;
+  int threads = s21_sched.stop ? 0 : s21_sched.threads;  // already stopping
+  if (threads) s21_sched.stop = 1;
+  pthread_cond_broadcast(&s21_sched.cond);
+  pthread_mutex_unlock(&s21_sched.lock);
+  FOR(threads) pthread_join(workers[i], NULL);
+  if (!threads) return;
+  pthread_mutex_lock(&s21_sched.lock);
+  s21_sched.workers = NULL;
+  pthread_mutex_unlock(&s21_sched.lock);
+  free(workers);
+}
@@ -0,0 +1,207 @@
+#include <string.h>
+
+#include "s21_matrix.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define FIRST(B, i) MAX(0, (i) - (B)->kl)
+#define LAST(B, i) MIN((B)->n - 1, (i) + (B)->ku)
+#define AT(B, i, j) (B)->row[i][(j)-FIRST(B, i)]
+
+//===================   STRUCTURED   =======================
+
+static int s21_band_valid(s21_band_t *B) {
+  return B && B->row && B->data && B->n > 0 && B->kl >= 0 && B->ku >= 0;
+}
+
+int s21_create_band(int n, int kl, int ku, s21_band_t *result) {
+  if (!result || n <= 0 || kl < 0 || ku < 0) return ERR_FAIL;
+  *result = (s21_band_t){.n = n, .kl = MIN(kl, n - 1), .ku = MIN(ku, n - 1)};
+  size_t total = 0;
+  FOR(n) total += LAST(result, i) - FIRST(result, i) + 1;
+  result->row = malloc(sizeof(double *) * n);
+  result->data = calloc(total, sizeof(double));
+  if (!result->row || !result->data) return s21_remove_band(result), ERR_FAIL;
+  double *p = result->data;
+  FOR(n) result->row[i] = p, p += LAST(result, i) - FIRST(result, i) + 1;
+  S21_STAT_BYTES((long long)(total * sizeof(double)));
+  return OK;
+}
+
+int s21_create_triangular(int n, int uplo, s21_band_t *result) {
+  if (uplo != S21_UPPER && uplo != S21_LOWER) return ERR_FAIL;
+  return uplo == S21_UPPER ? s21_create_band(n, 0, n - 1, result)
+                           : s21_create_band(n, n - 1, 0, result);
+}
+
+void s21_remove_band(s21_band_t *B) {
+  if (!B) return;
+  if (s21_band_valid(B)) {
+    size_t total = 0;
+    FOR(B->n) total += LAST(B, i) - FIRST(B, i) + 1;
+    S21_STAT_BYTES(-(long long)(total * sizeof(double)));
+  }
+  free(B->row), free(B->data);
+  B->row = NULL, B->data = NULL;
+}
+
+double *s21_band_at(s21_band_t *B, int i, int j) {
+  if (!s21_band_valid(B) || i < 0 || i >= B->n || j < FIRST(B, i) ||
+      j > LAST(B, i))
+    return NULL;
+  return &AT(B, i, j);
+}
+
+// nonzeros outside the band cannot be stored and give ERR_CALC
+int s21_band_from_matrix(matrix_t *A, int kl, int ku, s21_band_t *result) {
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (!s21_check_square(A)) return ERR_CALC;
+  int akl, aku;
+  s21_matrix_bandwidth(A, &akl, &aku);
+  if (akl > kl || aku > ku) return ERR_CALC;
+  if (s21_create_band(A->rows, kl, ku, result)) return ERR_FAIL;
+  FOR(result->n) for (int j = FIRST(result, i); j <= LAST(result, i); j++)
+    AT(result, i, j) = A->matrix[i][j];
+  return OK;
+}
+
+int s21_band_to_matrix(s21_band_t *B, matrix_t *result) {
+  if (!s21_band_valid(B) || !result) return ERR_FAIL;
+  if (s21_create_matrix(B->n, B->n, result)) return ERR_FAIL;
+  FOR(B->n) for (int j = FIRST(B, i); j <= LAST(B, i); j++)
+    result->matrix[i][j] = AT(B, i, j);
+  return OK;
+}
+
+// lowest kl, ku with every nonzero inside the band, O(n^2) scan
+int s21_matrix_bandwidth(matrix_t *A, int *kl, int *ku) {
+  if (!s21_m_valid(A) || !kl || !ku) return ERR_FAIL;
+  *kl = *ku = 0;
+  FORS(A->rows, A->columns) if (A->matrix[i][j] != 0) {
+    if (i - j > *kl) *kl = i - j;
+    if (j - i > *ku) *ku = j - i;
+  }
+  return OK;
+}
+
+// result = B X in O(n (kl + ku + 1) m)
+S21_CLONES int s21_band_mult(s21_band_t *B, matrix_t *X, matrix_t *result) {
+  if (!s21_band_valid(B) || !s21_m_valid(X) || !result) return ERR_FAIL;
+  if (X->rows != B->n) return ERR_CALC;
+  if (s21_create_matrix(B->n, X->columns, result)) return ERR_FAIL;
+  int m = X->columns;
+  FOR(B->n) {
+    double *restrict r = result->matrix[i];
+    for (int k = FIRST(B, i); k <= LAST(B, i); k++) {
+      const double v = AT(B, i, k), *restrict x = X->matrix[k];
+      for (int j = 0; j < m; j++) r[j] += v * x[j];
+    }
+  }
+  return OK;
+}
+
+typedef struct {
+  double *w;     // row i keeps columns i - kl .. i + kl + ku
+  int n, kl, u;  // u: upper bandwidth after pivoting fill
+} s21_band_lu_t;
+
+#define W(f, i, j) \
+  (f)->w[(size_t)(i) * ((f)->kl + (f)->u + 1) + (j) - (i) + (f)->kl]
+
+// Gaussian elimination with partial pivoting inside the band; row swaps
+// widen the upper band to kl + ku and are replayed on X when given
+static int s21_band_lu(s21_band_t *B, s21_band_lu_t *f, matrix_t *X,
+                       int *sign) {
+  int n = B->n, kl = B->kl;
+  *f = (s21_band_lu_t){.n = n, .kl = kl, .u = MIN(n - 1, kl + B->ku)};
+  f->w = calloc((size_t)n * (kl + f->u + 1), sizeof(double));
+  if (!f->w) return ERR_FAIL;
+  FOR(n) for (int j = FIRST(B, i); j <= LAST(B, i); j++) {
+    W(f, i, j) = AT(B, i, j);
+  }
+  *sign = 1;
+  for (int k = 0; k < n; k++) {
+    int last = MIN(n - 1, k + kl), right = MIN(n - 1, k + f->u), p = k;
+    for (int i = k + 1; i <= last; i++)
+      if (fabs(W(f, i, k)) > fabs(W(f, p, k))) p = i;
+    if (W(f, p, k) == 0) return ERR_CALC;
+    if (p != k) {
+      for (int j = k; j <= right; j++) {
+        double t = W(f, k, j);
+        W(f, k, j) = W(f, p, j), W(f, p, j) = t;
+      }
+      if (X) {
+        double *t = X->matrix[k];
+        X->matrix[k] = X->matrix[p], X->matrix[p] = t;
+      }
+      *sign = -*sign;
+    }
+    for (int i = k + 1; i <= last; i++) {
+      double l = W(f, i, k) / W(f, k, k);
+      for (int j = k + 1; j <= right; j++) W(f, i, j) -= l * W(f, k, j);
+      for (int j = 0; X && j < X->columns; j++)
+        X->matrix[i][j] -= l * X->matrix[k][j];
+    }
+  }
+  return OK;
+}
+
+// triangular bands substitute directly, the rest go through the band LU;
+// O(n (kl + ku + 1) m) either way
+int s21_band_solve(s21_band_t *B, matrix_t *X, matrix_t *result) {
+  if (!s21_band_valid(B) || !s21_m_valid(X) || !result) return ERR_FAIL;
+  if (X->rows != B->n) return ERR_CALC;
+  int n = B->n, m = X->columns;
+  FOR(n) if (B->kl * B->ku == 0 && AT(B, i, i) == 0) return ERR_CALC;
+  if (s21_create_matrix(n, m, result)) return ERR_FAIL;
+  double **x = result->matrix;
+  FORS(n, m) x[i][j] = X->matrix[i][j];
+
+  if (!B->ku) {  // lower: forward substitution
+    FOR(n) {
+      for (int k = FIRST(B, i); k < i; k++)
+        for (int j = 0; j < m; j++) x[i][j] -= AT(B, i, k) * x[k][j];
+      for (int j = 0; j < m; j++) x[i][j] /= AT(B, i, i);
+    }
+    return OK;
+  }
+  if (!B->kl) {  // upper: back substitution
+    for (int i = n - 1; i >= 0; i--) {
+      for (int k = i + 1; k <= LAST(B, i); k++)
+        for (int j = 0; j < m; j++) x[i][j] -= AT(B, i, k) * x[k][j];
+      for (int j = 0; j < m; j++) x[i][j] /= AT(B, i, i);
+    }
+    return OK;
+  }
+  s21_band_lu_t f;
+  int sign, status = s21_band_lu(B, &f, result, &sign);
+  for (int i = n - 1; i >= 0 && !status; i--) {
+    for (int k = i + 1; k <= MIN(n - 1, i + f.u); k++)
+      for (int j = 0; j < m; j++) x[i][j] -= W(&f, i, k) * x[k][j];
+    for (int j = 0; j < m; j++) x[i][j] /= W(&f, i, i);
+  }
+  free(f.w);
+  if (status) s21_remove_matrix(result);
+  return status;
+}
+
+// triangular: the product of the diagonal, otherwise of the LU pivots
+int s21_band_determinant(s21_band_t *B, double *result) {
+  if (!s21_band_valid(B) || !result) return ERR_FAIL;
+  double det = 1;
+  if (!B->kl || !B->ku) {
+    FOR(B->n) det *= AT(B, i, i);
+    *result = det;
+    return OK;
+  }
+  s21_band_lu_t f;
+  int sign, status = s21_band_lu(B, &f, NULL, &sign);
+  if (status != ERR_FAIL) {
+    det = sign;
+    FOR(B->n) det *= W(&f, i, i);
+    *result = status ? 0 : det;
+    status = OK;
+  }
+  free(f.w);
+  return status;
+}
@@ -9,21 +9,58 @@ int s21_m_eqdim(M_AB) { return A->rows == B->rows && A->columns == B->columns; }
 
 //==================   BASIC   ============================
 
+#define BYTES(r, c) ((long long)(r) * (sizeof(double *) + (c) * sizeof(double)))
+
 void s21_remove_matrix(M_A) {
   if (!A) return;
-  if (s21_m_valid(A)) FOR(A->rows) free(A->matrix[i]);
-  free(A->matrix), A->matrix = NULL;
+  if (A->share && !s21_share_release(A)) return;  // other handles remain
+  int owner = s21_m_valid(A) && !(A->flags & S21_M_VIEW);
+  if (owner) S21_STAT_BYTES(-BYTES(A->rows, A->columns));
+  if (owner && !A->block) FOR(A->rows) free(A->matrix[i]);
+  if (!(A->flags & S21_M_VIEW)) free(A->block);
+  free(A->matrix), A->matrix = NULL, A->block = NULL;
 }
 
 #define NULLS(x, y, z) !(x = calloc(y, sizeof(z)))
 int s21_create_matrix(int rows, int columns, matrix_t *result) {
+  S21_STAT(S21_OP_CREATE, 0);
   if (rows == 0 || columns == 0) return ERR_FAIL;
+  result->flags = S21_ALLOC_DEFAULT, result->block = NULL, result->ld = 0;
+  result->share = NULL;
   if (NULLS(result->matrix, rows, double *)) return ERR_FAIL;
   FOR(rows)
-  if (NULLS(result->matrix[i], columns, double))
-    return s21_remove_matrix(result), ERR_FAIL;
+  if (NULLS(result->matrix[i], columns, double)) {
+    while (i--) free(result->matrix[i]);
+    return free(result->matrix), result->matrix = NULL, ERR_FAIL;
+  }
 
   result->rows = rows, result->columns = columns;
+  S21_STAT_BYTES(BYTES(rows, columns));
+  return OK;
+}
+
+int s21_create_matrix_ex(int rows, int columns, int flags, matrix_t *result) {
+  if (!flags) return s21_create_matrix(rows, columns, result);
+  S21_STAT(S21_OP_CREATE, 0);
+  if (!result || rows <= 0 || columns <= 0) return ERR_FAIL;
+  int status = s21_alloc_block(rows, columns, flags, result);
+  if (!status) S21_STAT_BYTES(BYTES(rows, columns));
+  return status;
+}
+
+int s21_wrap_matrix(double *data, int rows, int columns, int stride,
+                    int ownership, matrix_t *result) {
+  if (!data || !result || rows <= 0 || columns <= 0) return ERR_FAIL;
+  if (!stride) stride = columns;
+  if (stride < columns) return ERR_CALC;
+  double **rp = malloc(sizeof(double *) * rows);
+  if (!rp) return ERR_FAIL;
+  FOR(rows) rp[i] = data + (size_t)i * stride;
+  int owned = ownership == S21_WRAP_OWN;
+  *result = (matrix_t){.matrix = rp, .rows = rows, .columns = columns,
+                       .flags = owned ? S21_ALLOC_CONTIGUOUS : S21_M_VIEW,
+                       .block = data, .ld = stride};
+  if (owned) S21_STAT_BYTES(BYTES(rows, columns));
   return OK;
 }
 
@@ -37,16 +74,66 @@ int s21_eq_matrix(M_AB) {
 
 //=================   CALCULATIONS   ======================
 
-#define SUMSUB(s)                                                             \
+typedef struct {
+  matrix_t *A, *B, *result;
+  double number;
+  int threads;
+} s21_elementwise_t;
+
+// row band `task` of result = A s B, or A s number when there is no B
+#define S21_ELEMENTWISE(name, s)                                      \
+  S21_CLONES static void name(void *ctx, int task, int tid) {         \
+    (void)tid;                                                        \
+    s21_elementwise_t *e = ctx;                                       \
+    int n = e->A->columns, rows = e->A->rows;                         \
+    int lo = (int)((long)rows * task / e->threads);                   \
+    int hi = (int)((long)rows * (task + 1) / e->threads);             \
+    for (int i = lo; i < hi; i++) {                                   \
+      double *restrict r = e->result->matrix[i];                      \
+      const double *restrict a = e->A->matrix[i];                     \
+      if (e->B)                                                       \
+        for (int j = 0; j < n; j++) r[j] = a[j] s e->B->matrix[i][j]; \
+      else                                                            \
+        for (int j = 0; j < n; j++) r[j] = a[j] s e->number;          \
+    }                                                                 \
+  }
+
+S21_ELEMENTWISE(s21_sum_band, +)
+S21_ELEMENTWISE(s21_sub_band, -)
+S21_ELEMENTWISE(s21_scale_band, *)
+
+// rows are split over threads once the planner finds the pass big enough
+static int s21_elementwise(s21_op_t op, s21_task_fn band, matrix_t *A,
+                           matrix_t *B, double number, matrix_t *result) {
+  s21_plan_t plan;
+  s21_plan(op, A, B, &plan);
+  s21_elementwise_t e = {A, B, result, number, plan.threads};
+  int status = OK;
+  if (plan.threads > 1)
+    status = s21_parallel_static(plan.threads, band, &e);
+  else
+    band(&e, 0, 0);
+  if (status) s21_remove_matrix(result);
+  return status;
+}
+
+#define SUMSUB(op, band)                                                      \
   if (!s21_m_valid(A) || !s21_m_valid(B)) return ERR_FAIL;                    \
   if (!s21_m_eqdim(A, B) || !!s21_create_matrix(A->rows, A->columns, result)) \
     return ERR_CALC;                                                          \
-  FORS(A->rows, A->columns)                                                   \
-  result->matrix[i][j] = A->matrix[i][j] s B->matrix[i][j];                   \
-  return OK;
+  return s21_elementwise(op, band, A, B, 0, result);
 
-int s21_sum_matrix(M_ABRES) { SUMSUB(+); }
-int s21_sub_matrix(M_ABRES) { SUMSUB(-); }
+#define FLOPS_AB(x) (s21_m_valid(A) && s21_m_valid(B) ? (x) : 0)
+#define FLOPS_A(x) (s21_m_valid(A) ? (x) : 0)
+
+int s21_sum_matrix(M_ABRES) {
+  S21_STAT(S21_OP_SUM, FLOPS_AB(1.0 * A->rows * A->columns));
+  SUMSUB(S21_OP_SUM, s21_sum_band);
+}
+int s21_sub_matrix(M_ABRES) {
+  S21_STAT(S21_OP_SUB, FLOPS_AB(1.0 * A->rows * A->columns));
+  SUMSUB(S21_OP_SUB, s21_sub_band);
+}
 
 #define MULT(a, b) ((a) * (b))
 #define DIV(a, b) (!b ? a / b : ERR_CALC)
@@ -56,11 +143,12 @@ int s21_sub_matrix(M_ABRES) { SUMSUB(-); }
   if (!!s21_create_matrix(A->rows, A->columns, result) || !is_fin(number)) \
     return ERR_CALC;                                                       \
   FORS(A->rows, A->columns) if (!is_fin(A->matrix[i][j])) return ERR_CALC; \
-  FORS(A->rows, A->columns)                                                \
-  result->matrix[i][j] += s(A->matrix[i][j], number);                      \
-  return OK;
+  return s21_elementwise(S21_OP_MULT_NUMBER, s, A, NULL, number, result);
 
-int s21_mult_number(M_ANRES) { MULTDIVN(MULT); }
+int s21_mult_number(M_ANRES) {
+  S21_STAT(S21_OP_MULT_NUMBER, FLOPS_A(1.0 * A->rows * A->columns));
+  MULTDIVN(s21_scale_band);
+}
 // int s21_div_number(M_ANRES) { MULTDIVN(DIV); }  // extra (not required)
 
 #define MULTDIV(s)                                                       \
@@ -71,5 +159,28 @@ int s21_mult_number(M_ANRES) { MULTDIVN(MULT); }
   result->matrix[i][j] += A->matrix[i][k] * B->matrix[k][j];             \
   return OK;
 
-int s21_mult_matrix(M_ABRES) { MULTDIV(MULT); }
+S21_CLONES static int s21_mult_small(M_ABRES) { MULTDIV(MULT); }
+
+int s21_mult_matrix(M_ABRES) {
+  s21_tuning_t t;
+  s21_tuning_get(&t);
+  return s21_mult_matrix_ex(A, B, result, t.accumulate);
+}
+
+// invalid shapes fall to the triple loop, which reports them
+int s21_mult_matrix_ex(M_ABRES, int accumulate) {
+  S21_STAT(S21_OP_MULT, FLOPS_AB(2.0 * A->rows * A->columns * B->columns));
+  if (accumulate < S21_ACC_FAST || accumulate > S21_ACC_DOT2) return ERR_FAIL;
+  s21_tuning_t t;
+  s21_tuning_get(&t);
+  t.accumulate = accumulate;
+  s21_plan_t plan;
+  if (!result || s21_plan_ex(S21_OP_MULT, A, B, &t, &plan) ||
+      plan.algo <= S21_ALGO_SMALL)
+    return s21_mult_small(A, B, result);
+  if (!!s21_create_matrix(A->rows, B->columns, result)) return ERR_CALC;
+  int status = s21_gemm(&plan, A, B, result);
+  if (status) s21_remove_matrix(result);
+  return status;
+}
 // // int s21_div_matrix(M_ABRES) { MULTDIV(DIV); }  // extra (not required)
@@ -0,0 +1,31 @@
+#define _GNU_SOURCE
+#include <time.h>
+
+#include "s21_matrix.h"
+
+//==================   CANCELLATION   ======================
+
+static double s21_monotonic(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void s21_cancel_init(s21_cancel_t *token, double timeout_seconds) {
+  if (!token) return;
+  atomic_init(&token->cancelled, 0);
+  token->deadline = timeout_seconds > 0 ? s21_monotonic() + timeout_seconds : 0;
+}
+
+void s21_cancel(s21_cancel_t *token) {
+  if (token) atomic_store(&token->cancelled, 1);
+}
+
+// an expired deadline latches into the flag, later polls skip the clock
+int s21_cancelled(s21_cancel_t *token) {
+  if (!token) return 0;
+  if (atomic_load_explicit(&token->cancelled, memory_order_relaxed)) return 1;
+  if (token->deadline <= 0 || s21_monotonic() < token->deadline) return 0;
+  atomic_store(&token->cancelled, 1);
+  return 1;
+}
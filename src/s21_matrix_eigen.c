@@ -0,0 +1,274 @@
+#include <float.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+#define MT_ROWS 256    // trailing rows below which a step stays serial
+#define MT_WORK 65536  // rotations x columns below which a sweep does too
+#define TILE 32        // eigenvector rows sharing each reflector pass
+#define MAX_SWEEPS 30  // QL sweeps allowed per eigenvalue
+#define LANES 4
+#define CUBE(n) ((double)(n) * (n) * (n))
+
+//======================   EIGEN   =========================
+
+S21_CLONES static double s21_dot_lanes(const double *restrict a,
+                                       const double *restrict b, int n) {
+  double acc[LANES] = {0};
+  int j = 0;
+  for (; j + LANES <= n; j += LANES)
+    for (int l = 0; l < LANES; l++) acc[l] += a[j + l] * b[j + l];
+  double s = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for (; j < n; j++) s += a[j] * b[j];
+  return s;
+}
+
+// H x = beta e1 with H = I - tau v v^T; v overwrites x with v[0] = 1
+static double s21_reflector(double *x, int len, double *tau) {
+  double alpha = x[0], xnorm = 0, beta = alpha;
+  for (int i = 1; i < len; i++) xnorm = hypot(xnorm, x[i]);
+  *tau = 0;
+  if (xnorm != 0) {
+    beta = -copysign(hypot(alpha, xnorm), alpha);
+    for (int i = 1; i < len; i++) x[i] /= alpha - beta;
+    *tau = (beta - alpha) / beta;
+  }
+  x[0] = 1;
+  return beta;
+}
+
+typedef struct {
+  double **a, *p;
+  const double *v, *w, *next;  // v, w index from column lo - 1
+  int lo, n, threads;
+} s21_tridiag_t;
+
+// rows lo.. of the trailing block: S -= v w^T + w v^T, then p = S next;
+// fusing the two saves a sweep over S per step
+S21_CLONES static void s21_tridiag_band(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_tridiag_t *t = ctx;
+  int rows = t->n - t->lo, len = t->n - t->lo;
+  int i0 = t->lo + (int)((long)rows * task / t->threads);
+  int i1 = t->lo + (int)((long)rows * (task + 1) / t->threads);
+  for (int i = i0; i < i1; i++) {
+    double *restrict row = t->a[i] + t->lo;
+    if (t->w) {
+      const double *restrict v = t->v + 1, *restrict w = t->w + 1;
+      double vi = v[i - t->lo], wi = w[i - t->lo];
+      for (int j = 0; j < len; j++) row[j] -= vi * w[j] + wi * v[j];
+    }
+    if (t->next) t->p[i] = s21_dot_lanes(row, t->next, len);
+  }
+}
+
+static int s21_tridiag_pass(s21_tridiag_t *t, int threads) {
+  t->threads = t->n - t->lo >= MT_ROWS ? threads : 1;
+  if (t->threads > 1)
+    return s21_parallel_static(t->threads, s21_tridiag_band, t);
+  s21_tridiag_band(t, 0, 0);
+  return OK;
+}
+
+// Householder reduction Q^T A Q = T of the full symmetric a; diagonal d,
+// off-diagonal e, reflector k kept in row k right of the diagonal.
+// Unblocked like DSYTD2: every step is one fused sweep of the trailing
+// block, so it runs at memory speed. A DSYTRD panel would turn the rank-2
+// updates into a rank-2nb gemm but keep one S v sweep per column
+static int s21_tridiagonal(double **a, int n, double *d, double *e,
+                           double *tau, double *scratch, int threads) {
+  double *p = scratch, *w = scratch + n;
+  FOR(n) d[i] = a[i][i], e[i] = tau[i] = 0;
+  if (n == 1) return OK;
+  if (n == 2) return e[0] = a[0][1], OK;
+  e[0] = s21_reflector(a[0] + 1, n - 1, &tau[0]);
+  s21_tridiag_t t = {.a = a, .p = p, .next = a[0] + 1, .lo = 1, .n = n};
+  int status = s21_tridiag_pass(&t, threads);
+  for (int k = 0; k < n - 2 && !status; k++) {
+    int r = n - k - 1;
+    const double *v = a[k] + k + 1;
+    double pv = 0;  // w = tau S v - tau^2 / 2 (v^T S v) v
+    for (int j = 0; j < r; j++) w[j] = tau[k] * p[k + 1 + j], pv += w[j] * v[j];
+    for (int j = 0; j < r; j++) w[j] -= 0.5 * tau[k] * pv * v[j];
+    double *row = a[k + 1];
+    for (int j = k + 1; j < n; j++)
+      row[j] -= w[j - k - 1] + w[0] * v[j - k - 1];
+    d[k + 1] = row[k + 1];
+    t = (s21_tridiag_t){.a = a, .p = p, .v = v, .w = w, .lo = k + 2, .n = n};
+    if (k + 1 < n - 2) {
+      e[k + 1] = s21_reflector(row + k + 2, r - 1, &tau[k + 1]);
+      t.next = row + k + 2;
+    } else {
+      e[k + 1] = row[k + 2];
+    }
+    status = s21_tridiag_pass(&t, threads);
+  }
+  d[n - 1] = a[n - 1][n - 1];
+  return status;
+}
+
+typedef struct {
+  double **z, *c, *s;
+  int *at, count, n, threads;
+} s21_sweep_t;
+
+// replays one QL sweep of rotations on a band of columns of z, the
+// eigenvectors held as rows
+S21_CLONES static void s21_sweep_band(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_sweep_t *q = ctx;
+  int j0 = (int)((long)q->n * task / q->threads);
+  int j1 = (int)((long)q->n * (task + 1) / q->threads);
+  for (int r = 0; r < q->count; r++) {
+    double *restrict zi = q->z[q->at[r]], *restrict zn = q->z[q->at[r] + 1];
+    const double c = q->c[r], s = q->s[r];
+    for (int j = j0; j < j1; j++) {
+      double f = zn[j];
+      zn[j] = s * zi[j] + c * f;
+      zi[j] = c * zi[j] - s * f;
+    }
+  }
+}
+
+static int s21_sweep_apply(s21_sweep_t *q, int threads) {
+  if (!q->z || !q->count) return OK;
+  q->threads = (long)q->count * q->n >= MT_WORK ? threads : 1;
+  if (q->threads > 1) return s21_parallel_static(q->threads, s21_sweep_band, q);
+  s21_sweep_band(q, 0, 0);
+  return OK;
+}
+
+// implicit QL with Wilkinson shifts on d, e (e[n - 1] unused); rotations
+// go to the rows of z when given
+static int s21_tridiag_ql(double *d, double *e, int n, s21_sweep_t *q,
+                          int threads) {
+  e[n - 1] = 0;
+  for (int l = 0, m; l < n; l++) {
+    for (int sweeps = 0;; sweeps++) {
+      for (m = l; m < n - 1; m++)
+        if (fabs(e[m]) <= DBL_EPSILON * (fabs(d[m]) + fabs(d[m + 1]))) break;
+      if (m == l) break;
+      if (sweeps == MAX_SWEEPS) return ERR_CALC;
+      double g = (d[l + 1] - d[l]) / (2 * e[l]), r = hypot(g, 1);
+      double s = 1, c = 1, p = 0;
+      g = d[m] - d[l] + e[l] / (g + copysign(r, g));
+      int i = m - 1;
+      q->count = 0;
+      for (; i >= l; i--) {
+        double f = s * e[i], b = c * e[i];
+        e[i + 1] = r = hypot(f, g);
+        if (r == 0) break;  // split, the sweep restarts on the smaller part
+        s = f / r, c = g / r;
+        g = d[i + 1] - p;
+        r = (d[i] - g) * s + 2 * c * b;
+        d[i + 1] = g + (p = s * r);
+        g = c * r - b;
+        if (q->z) q->at[q->count] = i, q->c[q->count] = c;
+        if (q->z) q->s[q->count++] = s;
+      }
+      if (s21_sweep_apply(q, threads)) return ERR_FAIL;
+      if (i >= l) {
+        d[i + 1] -= p, e[m] = 0;
+        continue;
+      }
+      d[l] -= p, e[l] = g, e[m] = 0;
+    }
+  }
+  return OK;
+}
+
+typedef struct {
+  double **a, *tau, **z;
+  int n, threads;
+} s21_back_t;
+
+// z_i := Q z_i = H_0 ... H_n-3 z_i for a band of rows, TILE rows share
+// every pass over a reflector
+S21_CLONES static void s21_back_band(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_back_t *b = ctx;
+  int n = b->n, i0 = (int)((long)n * task / b->threads);
+  int i1 = (int)((long)n * (task + 1) / b->threads);
+  for (int t0 = i0; t0 < i1; t0 += TILE) {
+    int t1 = t0 + TILE < i1 ? t0 + TILE : i1;
+    for (int k = n - 3; k >= 0; k--) {
+      if (b->tau[k] == 0) continue;
+      const double *restrict v = b->a[k] + k + 1;
+      for (int i = t0; i < t1; i++) {
+        double *restrict y = b->z[i] + k + 1;
+        double f = b->tau[k] * s21_dot_lanes(v, y, n - k - 1);
+        for (int j = 0; j < n - k - 1; j++) y[j] -= f * v[j];
+      }
+    }
+  }
+}
+
+// ascending selection sort, eigenvector rows follow by pointer swap
+static void s21_eigen_sort(double *d, double **z, int n) {
+  FOR(n) {
+    int min = i;
+    for (int j = i + 1; j < n; j++)
+      if (d[j] < d[min]) min = j;
+    double t = d[i];
+    d[i] = d[min], d[min] = t;
+    if (!z) continue;
+    double *row = z[i];
+    z[i] = z[min], z[min] = row;
+  }
+}
+
+typedef struct {
+  matrix_t a, z;
+  double *buf;
+  int *at;
+} s21_eigen_ws_t;
+
+static void s21_eigen_free(s21_eigen_ws_t *ws) {
+  s21_remove_matrix(&ws->a);
+  s21_remove_matrix(&ws->z);
+  free(ws->buf);
+  free(ws->at);
+}
+
+static int s21_eigen_alloc(int n, int vectors, s21_eigen_ws_t *ws) {
+  *ws = (s21_eigen_ws_t){0};
+  ws->buf = malloc(sizeof(double) * 5 * n);
+  ws->at = malloc(sizeof(int) * n);
+  if (!ws->buf || !ws->at || s21_create_matrix(n, n, &ws->a) ||
+      (vectors && s21_create_matrix(n, n, &ws->z)))
+    return s21_eigen_free(ws), ERR_FAIL;
+  return OK;
+}
+
+int s21_eigen_sym(matrix_t *A, s21_vector_t *values, matrix_t *vectors) {
+  S21_STAT(S21_OP_EIGEN,
+           s21_m_valid(A) ? (vectors ? 7.0 : 2.0) * CUBE(A->rows) : 0);
+  if (!s21_m_valid(A) || !values) return ERR_FAIL;
+  if (!s21_check_square(A)) return ERR_CALC;
+  int n = A->rows;
+  s21_eigen_ws_t ws;
+  if (s21_eigen_alloc(n, vectors != NULL, &ws)) return ERR_FAIL;
+  s21_plan_t plan;
+  s21_plan(S21_OP_EIGEN, A, NULL, &plan);
+  double **a = ws.a.matrix, *d = ws.buf, *e = d + n, *tau = e + n;
+  FOR(n) for (int j = 0; j <= i; j++) a[i][j] = a[j][i] = A->matrix[i][j];
+
+  int status = s21_tridiagonal(a, n, d, e, tau, tau + n, plan.threads);
+  s21_sweep_t q = {.z = vectors ? ws.z.matrix : NULL, .c = tau + n,
+                   .s = tau + 2 * n, .at = ws.at, .n = n};
+  if (vectors) FOR(n) ws.z.matrix[i][i] = 1;
+  if (!status) status = s21_tridiag_ql(d, e, n, &q, plan.threads);
+  s21_back_t b = {.a = a, .tau = tau, .z = q.z, .n = n,
+                  .threads = s21_thread_count(plan.threads, n)};
+  if (!status && vectors && b.threads > 1)
+    status = s21_parallel_static(b.threads, s21_back_band, &b);
+  else if (!status && vectors)
+    s21_back_band(&b, 0, 0);
+  if (!status) s21_eigen_sort(d, q.z, n);
+  if (!status) status = s21_create_vector(n, values);
+  if (!status) memcpy(values->data, d, sizeof(double) * n);
+  if (!status && vectors && s21_transpose(&ws.z, vectors))
+    status = ERR_FAIL, s21_remove_vector(values);
+  s21_eigen_free(&ws);
+  return status;
+}
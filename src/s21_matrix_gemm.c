@@ -0,0 +1,281 @@
+#include <string.h>
+
+#include "s21_matrix.h"
+
+//=====================   GEMM   ===========================
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// c[r0..r1) += a * b in bs x bs tiles, i-k-j inside a tile; every c[i][j]
+// still sees its products in ascending k, so results match the triple loop
+S21_CLONES static void s21_gemm_rows(double **a, double **b, double **c,
+                                     int r0, int r1, int k, int n, int bs) {
+  for (int kk = 0; kk < k; kk += bs)
+    for (int jj = 0; jj < n; jj += bs)
+      for (int i = r0; i < r1; i++) {
+        double *restrict ci = c[i] + jj;
+        int kend = MIN(kk + bs, k), w = MIN(bs, n - jj);
+        for (int p = kk; p < kend; p++) {
+          const double aip = a[i][p], *restrict bp = b[p] + jj;
+          for (int j = 0; j < w; j++) ci[j] += aip * bp[j];
+        }
+      }
+}
+
+//=================   ACCURATE SUMS   ======================
+
+#define SPLIT 134217729.0  // 2^27 + 1, Veltkamp splitting
+
+// r with h + r == a * b exactly for h = fl(a * b); Dekker's product
+// needs no FMA, so every clone vectorizes it
+static inline double s21_two_prod_dekker(double a, double b, double h) {
+  double t = SPLIT * a, ah = t - (t - a), al = a - ah;
+  t = SPLIT * b;
+  double bh = t - (t - b), bl = b - bh;
+  return ((ah * bh - h) + ah * bl + al * bh) + al * bl;
+}
+
+#define TWO_PROD_FMA(a, b, h) fma(a, b, -(h))
+#ifdef __FMA__
+#define TWO_PROD TWO_PROD_FMA
+#else
+#define TWO_PROD s21_two_prod_dekker
+#endif
+
+// Dot2 (Ogita, Rump, Oishi): s keeps the sum, e the rounding errors of
+// every product and addition, one lane per column of the tile
+#define S21_DOT2_ROWS(attr, name, two_prod)                                \
+  attr static void name(double **a, double **b, double **c, int r0, int r1, \
+                        int k, int n, int bs, double *restrict s,          \
+                        double *restrict e) {                              \
+    for (int jj = 0; jj < n; jj += bs) {                                   \
+      int w = MIN(bs, n - jj);                                             \
+      for (int i = r0; i < r1; i++) {                                      \
+        memset(s, 0, sizeof(double) * w);                                  \
+        memset(e, 0, sizeof(double) * w);                                  \
+        for (int p = 0; p < k; p++) {                                      \
+          const double aip = a[i][p], *restrict bp = b[p] + jj;            \
+          for (int j = 0; j < w; j++) {                                    \
+            double h = aip * bp[j], r = two_prod(aip, bp[j], h);           \
+            double x = s[j] + h, z = x - s[j];                             \
+            e[j] += ((s[j] - (x - z)) + (h - z)) + r;                      \
+            s[j] = x;                                                      \
+          }                                                                \
+        }                                                                  \
+        for (int j = 0; j < w; j++) c[i][jj + j] += s[j] + e[j];           \
+      }                                                                    \
+    }                                                                      \
+  }
+
+S21_DOT2_ROWS(S21_CLONES, s21_dot2_rows, TWO_PROD)
+
+#ifdef S21_HAVE_CLONES
+// __FMA__ is tested once with the base flags, so the clones above all get
+// Dekker's product; FMA hosts run this copy instead, picked at run time
+S21_DOT2_ROWS(__attribute__((target("arch=x86-64-v3"))), s21_dot2_rows_fma,
+              TWO_PROD_FMA)
+#define DOT2_FMA() __builtin_cpu_supports("fma")
+#else
+#define s21_dot2_rows_fma s21_dot2_rows
+#define DOT2_FMA() 0
+#endif
+
+// k is cut into bs-wide blocks whose partial rows merge like a binary
+// counter, so the error grows with bs + log(k / bs) instead of k
+S21_CLONES static void s21_pairwise_rows(double **a, double **b, double **c,
+                                         int r0, int r1, int k, int n, int bs,
+                                         double *restrict stack) {
+  for (int jj = 0; jj < n; jj += bs) {
+    int w = MIN(bs, n - jj);
+    for (int i = r0; i < r1; i++) {
+      int top = 0;
+      for (int kk = 0, count = 0; kk < k; kk += bs, count++) {
+        double *restrict t = stack + (size_t)top++ * bs;
+        memset(t, 0, sizeof(double) * w);
+        for (int p = kk; p < MIN(kk + bs, k); p++) {
+          const double aip = a[i][p], *restrict bp = b[p] + jj;
+          for (int j = 0; j < w; j++) t[j] += aip * bp[j];
+        }
+        for (int carry = count; carry & 1; carry >>= 1, top--) {
+          double *restrict lo = stack + (size_t)(top - 2) * bs;
+          const double *restrict hi = lo + bs;
+          for (int j = 0; j < w; j++) lo[j] += hi[j];
+        }
+      }
+      for (double *hi = stack + (size_t)(top - 1) * bs; hi > stack; hi -= bs)
+        for (int j = 0; j < w; j++) hi[j - bs] += hi[j];
+      for (int j = 0; j < w && top; j++) c[i][jj + j] += stack[j];
+    }
+  }
+}
+
+typedef struct {
+  double **a, **b, **c;
+  int m, k, n, bs, threads, accumulate;
+  double *scratch;
+  size_t per_thread;
+} s21_gemm_t;
+
+// row bands line up with the first-touch bands of s21_create_matrix_ex
+static void s21_gemm_band(void *ctx, int task, int tid) {
+  s21_gemm_t *g = ctx;
+  int r0 = (int)((long)g->m * task / g->threads);
+  int r1 = (int)((long)g->m * (task + 1) / g->threads);
+  if (!g->accumulate) {
+    s21_gemm_rows(g->a, g->b, g->c, r0, r1, g->k, g->n, g->bs);
+    return;
+  }
+  double *own = g->scratch + g->per_thread * tid;
+  if (g->accumulate == S21_ACC_PAIRWISE)
+    s21_pairwise_rows(g->a, g->b, g->c, r0, r1, g->k, g->n, g->bs, own);
+  else if (DOT2_FMA())
+    s21_dot2_rows_fma(g->a, g->b, g->c, r0, r1, g->k, g->n, g->bs, own,
+                      own + g->bs);
+  else
+    s21_dot2_rows(g->a, g->b, g->c, r0, r1, g->k, g->n, g->bs, own,
+                  own + g->bs);
+}
+
+//====================   STRASSEN   ========================
+
+// z = x + s * y over h x h quadrants, y == NULL copies x
+static void s21_quad(const double *x, int ldx, const double *y, int ldy,
+                     double s, double *z, int h) {
+  FORS(h, h) z[i * h + j] = x[i * ldx + j] + (y ? s * y[i * ldy + j] : 0);
+}
+
+static void s21_quad_acc(double *c, int ldc, const double *m, int h,
+                         double s) {
+  FORS(h, h) c[i * ldc + j] += s * m[i * h + j];
+}
+
+S21_CLONES static void s21_leaf(const double *a, int lda, const double *b,
+                                int ldb, double *c, int ldc, int n) {
+  FOR(n) {
+    double *restrict ci = c + (size_t)i * ldc;
+    memset(ci, 0, sizeof(double) * n);
+    for (int p = 0; p < n; p++) {
+      const double aip = a[(size_t)i * lda + p],
+                   *restrict bp = b + (size_t)p * ldb;
+      for (int j = 0; j < n; j++) ci[j] += aip * bp[j];
+    }
+  }
+}
+
+// c = a * b for n x n operands, n is leaf << levels; each level keeps two
+// operand sums and one product, the product is folded into c right away
+static int s21_strassen(const double *a, int lda, const double *b, int ldb,
+                        double *c, int ldc, int n, int leaf) {
+  if (n <= leaf) return s21_leaf(a, lda, b, ldb, c, ldc, n), OK;
+  int h = n / 2;
+  size_t hh = (size_t)h * h;
+  double *t = malloc(sizeof(double) * 3 * hh);
+  if (!t) return ERR_FAIL;
+  double *t1 = t, *t2 = t + hh, *m = t + 2 * hh;
+  const double *a11 = a, *a12 = a + h, *a21 = a + (size_t)h * lda,
+               *a22 = a21 + h;
+  const double *b11 = b, *b12 = b + h, *b21 = b + (size_t)h * ldb,
+               *b22 = b21 + h;
+  double *c11 = c, *c12 = c + h, *c21 = c + (size_t)h * ldc, *c22 = c21 + h;
+  FORS(n, n) c[i * ldc + j] = 0;
+
+  // operand sums (x, y, sign) per product and the quadrants it lands in
+  struct {
+    const double *x, *y;
+    double s;
+    const double *u, *v;
+    double r;
+    double *d1, *d2;
+    double s1, s2;
+  } p[7] = {
+      {a11, a22, 1, b11, b22, 1, c11, c22, 1, 1},
+      {a21, a22, 1, b11, NULL, 0, c21, c22, 1, -1},
+      {a11, NULL, 0, b12, b22, -1, c12, c22, 1, 1},
+      {a22, NULL, 0, b21, b11, -1, c11, c21, 1, 1},
+      {a11, a12, 1, b22, NULL, 0, c11, c12, -1, 1},
+      {a21, a11, -1, b11, b12, 1, c22, NULL, 1, 0},
+      {a12, a22, -1, b21, b22, 1, c11, NULL, 1, 0},
+  };
+  int status = OK;
+  for (int q = 0; q < 7 && !status; q++) {
+    s21_quad(p[q].x, lda, p[q].y, lda, p[q].s, t1, h);
+    s21_quad(p[q].u, ldb, p[q].v, ldb, p[q].r, t2, h);
+    status = s21_strassen(t1, h, t2, h, m, h, h, leaf);
+    s21_quad_acc(p[q].d1, ldc, m, h, p[q].s1);
+    if (p[q].d2) s21_quad_acc(p[q].d2, ldc, m, h, p[q].s2);
+  }
+  free(t);
+  return status;
+}
+
+// operands are copied into zero-padded e x e blocks, e = leaf' << levels
+static int s21_gemm_strassen(matrix_t *A, matrix_t *B, matrix_t *C,
+                             int leaf) {
+  int m = A->rows, k = A->columns, n = B->columns;
+  int hi = m > k ? m : k, levels = 0;
+  hi = hi > n ? hi : n;
+  while ((hi + (1 << levels) - 1) >> levels > leaf) levels++;
+  int base = (hi + (1 << levels) - 1) >> levels, e = base << levels;
+  size_t ee = (size_t)e * e;
+  double *a = calloc(3 * ee, sizeof(double));
+  if (!a) return ERR_FAIL;
+  double *b = a + ee, *c = b + ee;
+  FORS(m, k) a[(size_t)i * e + j] = A->matrix[i][j];
+  FORS(k, n) b[(size_t)i * e + j] = B->matrix[i][j];
+  int status = s21_strassen(a, e, b, e, c, e, e, base);
+  if (!status) FORS(m, n) C->matrix[i][j] += c[(size_t)i * e + j];
+  free(a);
+  return status;
+}
+
+// result += A * B with the kernel chosen by plan, result must already be
+// rows(A) x columns(B)
+int s21_gemm(const s21_plan_t *plan, M_ABRES) {
+  if (!plan || !s21_m_valid(A) || !s21_m_valid(B) || !s21_m_valid(result))
+    return ERR_FAIL;
+  if (A->columns != B->rows || result->rows != A->rows ||
+      result->columns != B->columns)
+    return ERR_CALC;
+  int m = A->rows, k = A->columns, n = B->columns;
+  double **a = A->matrix, **b = B->matrix, **c = result->matrix;
+  int bs = plan->block > 0 ? plan->block : m;
+
+  if (plan->accumulate) {  // per-thread partial rows, then the same bands
+    int threads = plan->threads > 1 ? plan->threads : 1, depth = 2;
+    for (int blocks = (k + bs - 1) / bs; blocks >>= 1;) depth++;
+    size_t per = (size_t)bs * (plan->accumulate == S21_ACC_DOT2 ? 2 : depth);
+    s21_gemm_t g = {.a = a, .b = b, .c = c, .m = m, .k = k, .n = n,
+                    .bs = bs, .threads = threads,
+                    .accumulate = plan->accumulate, .per_thread = per,
+                    .scratch = malloc(sizeof(double) * per * threads)};
+    if (!g.scratch) return ERR_FAIL;
+    int status = OK;
+    if (threads > 1)
+      status = s21_parallel_static(threads, s21_gemm_band, &g);
+    else
+      s21_gemm_band(&g, 0, 0);
+    free(g.scratch);
+    return status;
+  }
+
+  switch (plan->algo) {
+    case S21_ALGO_STRASSEN: {
+      s21_tuning_t t;
+      s21_tuning_get(&t);
+      return s21_gemm_strassen(A, B, result, t.strassen_leaf);
+    }
+    case S21_ALGO_THREADED:
+      if (plan->threads > 1) {
+        s21_gemm_t g = {.a = a, .b = b, .c = c, .m = m, .k = k, .n = n,
+                        .bs = bs, .threads = plan->threads};
+        return s21_parallel_static(plan->threads, s21_gemm_band, &g);
+      }
+      // fall through
+    case S21_ALGO_BLOCKED:
+      s21_gemm_rows(a, b, c, 0, m, k, n, bs);
+      return OK;
+    default:
+      FORS(m, n) for (int p = 0; p < k; p++) c[i][j] += a[i][p] * b[p][j];
+      return OK;
+  }
+}
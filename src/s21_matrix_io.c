@@ -0,0 +1,322 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "s21_matrix.h"
+
+#define BLOCK 4096          // data lines per parse task
+#define MT_BYTES (1 << 20)  // texts below this parse on the calling thread
+#define FIELD 26            // widest formatted value plus separator
+#define BANNER "%%MatrixMarket"
+
+//=====================   TEXT I/O   =======================
+
+enum { S21_TEXT_CSV, S21_TEXT_ARRAY, S21_TEXT_COORD };
+enum { S21_GENERAL, S21_SYMMETRIC, S21_SKEW };
+
+static const double s21_pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                   1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                   1e18, 1e19, 1e20, 1e21, 1e22};
+
+static const char *s21_blank(const char *p) {
+  while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+  return p;
+}
+
+static int s21_line_end(const char *p) {
+  p = s21_blank(p);
+  return *p == '\n' || *p == '\0';
+}
+
+// Clinger's fast path: up to 19 digits that fit 2^53 scaled by an exact
+// power of ten round correctly in one operation; the rest, nan and inf
+// go to strtod. NULL when no number starts at p
+static const char *s21_parse_double(const char *p, double *out) {
+  const char *start = p = s21_blank(p);
+  int neg = *p == '-', digits = 0, exp10 = 0, exact = 1, any = 0;
+  uint64_t mant = 0;
+  if (*p == '-' || *p == '+') p++;
+  for (; *p >= '0' && *p <= '9'; p++, any = 1) {
+    if (digits < 19)
+      mant = mant * 10 + (*p - '0'), digits += mant > 0;
+    else
+      exp10++, exact = 0;
+  }
+  if (*p == '.')
+    for (p++; *p >= '0' && *p <= '9'; p++, any = 1) {
+      if (digits < 19)
+        mant = mant * 10 + (*p - '0'), digits += mant > 0, exp10--;
+      else
+        exact = 0;
+    }
+  if (any && (*p == 'e' || *p == 'E')) {
+    const char *q = p + 1;
+    int eneg = *q == '-', e = 0;
+    if (*q == '-' || *q == '+') q++;
+    if (*q >= '0' && *q <= '9') {
+      for (; *q >= '0' && *q <= '9'; q++)
+        if (e < 100000) e = e * 10 + (*q - '0');
+      exp10 += eneg ? -e : e, p = q;
+    }
+  }
+  if (any && exact && mant <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+    double v = (double)mant;
+    v = exp10 < 0 ? v / s21_pow10[-exp10] : v * s21_pow10[exp10];
+    *out = neg ? -v : v;
+    return p;
+  }
+  char *end;
+  *out = strtod(start, &end);
+  return end == start ? NULL : end;
+}
+
+static const char *s21_parse_index(const char *p, long *out) {
+  p = s21_blank(p);
+  if (*p < '0' || *p > '9') return NULL;
+  for (*out = 0; *p >= '0' && *p <= '9'; p++)
+    if (*out < INT32_MAX) *out = *out * 10 + (*p - '0');
+  return p;
+}
+
+typedef struct {
+  const char **line;
+  matrix_t *A;
+  int *failed, lines, kind, symmetry, pattern;
+} s21_parse_t;
+
+// (row, column) of the e-th entry of a column-major array, only the lower
+// triangle (without the diagonal when skew) is stored for the symmetric
+static void s21_array_at(const s21_parse_t *t, long e, int *i, int *j) {
+  int m = t->A->rows, skew = t->symmetry == S21_SKEW;
+  if (t->symmetry == S21_GENERAL) {
+    *i = (int)(e % m), *j = (int)(e / m);
+    return;
+  }
+  for (*j = 0; e >= m - *j - skew; (*j)++) e -= m - *j - skew;
+  *i = *j + skew + (int)e;
+}
+
+static int s21_coord_line(const s21_parse_t *t, const char *p) {
+  long i, j;
+  double v = 1;
+  if (!(p = s21_parse_index(p, &i)) || !(p = s21_parse_index(p, &j)))
+    return ERR_FAIL;
+  if (!t->pattern && !(p = s21_parse_double(p, &v))) return ERR_FAIL;
+  if (!s21_line_end(p) || i < 1 || j < 1 || i > t->A->rows ||
+      j > t->A->columns)
+    return ERR_FAIL;
+  t->A->matrix[i - 1][j - 1] = v;
+  if (t->symmetry != S21_GENERAL && i != j)
+    t->A->matrix[j - 1][i - 1] = t->symmetry == S21_SKEW ? -v : v;
+  return OK;
+}
+
+static void s21_parse_block(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_parse_t *t = ctx;
+  long lo = (long)task * BLOCK, hi = lo + BLOCK;
+  if (hi > t->lines) hi = t->lines;
+  int i = 0, j = 0, n = t->A->columns, skew = t->symmetry == S21_SKEW;
+  if (t->kind == S21_TEXT_ARRAY) s21_array_at(t, lo, &i, &j);
+  for (long e = lo; e < hi && !t->failed[task]; e++) {
+    const char *p = t->line[e];
+    double v;
+    if (t->kind == S21_TEXT_COORD) {
+      t->failed[task] = s21_coord_line(t, p);
+    } else if (t->kind == S21_TEXT_CSV) {
+      for (int c = 0; c < n && p; c++) {
+        if (c) p = s21_blank(p), p = *p == ',' ? p + 1 : NULL;
+        if (p) p = s21_parse_double(p, &t->A->matrix[e][c]);
+      }
+      t->failed[task] = !p || !s21_line_end(p);
+    } else if (!(p = s21_parse_double(p, &v)) || !s21_line_end(p)) {
+      t->failed[task] = 1;
+    } else {
+      t->A->matrix[i][j] = v;
+      if (t->symmetry != S21_GENERAL) t->A->matrix[j][i] = skew ? -v : v;
+      if (++i == t->A->rows) j++, i = t->symmetry ? j + skew : 0;
+    }
+  }
+}
+
+// starts of the lines holding data: blank lines and, for Matrix Market,
+// % comments are dropped; *lines is NULL when there are none
+static int s21_index_lines(const char *p, int comments, const char ***lines,
+                           int *count) {
+  *count = 0, *lines = NULL;
+  for (int pass = 0; pass < 2; pass++) {
+    int n = 0;
+    for (const char *s = p; *s;) {
+      const char *end = strchr(s, '\n');
+      const char *first = s21_blank(s);
+      if (*first != '\n' && *first && !(comments && *first == '%')) {
+        if (pass) (*lines)[n] = s;
+        n++;
+      }
+      s = end ? end + 1 : s + strlen(s);
+    }
+    if (pass || !n) return *count = n, OK;
+    if (!(*lines = malloc(sizeof(char *) * n))) return ERR_FAIL;
+  }
+  return OK;
+}
+
+static int s21_parse_run(s21_parse_t *t, size_t bytes) {
+  int blocks = (t->lines + BLOCK - 1) / BLOCK, failed = 0;
+  if (!(t->failed = calloc(blocks + 1, sizeof(int)))) return ERR_FAIL;
+  s21_tuning_t tuning;
+  s21_tuning_get(&tuning);
+  int threads = s21_thread_count(tuning.threads, blocks);
+  if (bytes < MT_BYTES) threads = 1;
+  if (threads > 1)
+    failed = s21_parallel_for(blocks, threads, s21_parse_block, t);
+  else
+    FOR(blocks) s21_parse_block(t, i, 0);
+  FOR(blocks) failed |= t->failed[i];
+  free(t->failed);
+  return failed ? ERR_FAIL : OK;
+}
+
+// banner tokens: object, format, field, symmetry
+static int s21_banner(const char *text, s21_parse_t *t) {
+  char obj[16], fmt[16], field[16], sym[16];
+  int read = sscanf(text + strlen(BANNER), "%15s %15s %15s %15s", obj, fmt,
+                    field, sym);
+  if (read != 4 || strcasecmp(obj, "matrix")) return ERR_FAIL;
+  if (!strcasecmp(fmt, "array"))
+    t->kind = S21_TEXT_ARRAY;
+  else if (!strcasecmp(fmt, "coordinate"))
+    t->kind = S21_TEXT_COORD;
+  else
+    return ERR_FAIL;
+  t->pattern = !strcasecmp(field, "pattern");
+  if (strcasecmp(field, "real") && strcasecmp(field, "integer") &&
+      !(t->pattern && t->kind == S21_TEXT_COORD))
+    return ERR_FAIL;
+  if (!strcasecmp(sym, "general"))
+    t->symmetry = S21_GENERAL;
+  else if (!strcasecmp(sym, "symmetric"))
+    t->symmetry = S21_SYMMETRIC;
+  else if (!strcasecmp(sym, "skew-symmetric"))
+    t->symmetry = S21_SKEW;
+  else
+    return ERR_FAIL;
+  return OK;
+}
+
+// dimensions from the size line (Matrix Market) or the first data line
+// (CSV), and the number of data lines they call for
+static int s21_shape(s21_parse_t *t, const char **line, int lines, int *m,
+                     int *n, long *expect) {
+  const char *p = line[0];
+  long rows, cols, nnz = 0;
+  if (t->kind == S21_TEXT_CSV) {
+    *m = lines, *n = 1, *expect = lines;
+    for (; *p && *p != '\n'; p++) *n += *p == ',';
+    return OK;
+  }
+  if (!(p = s21_parse_index(p, &rows)) || !(p = s21_parse_index(p, &cols)))
+    return ERR_FAIL;
+  if (t->kind == S21_TEXT_COORD && !(p = s21_parse_index(p, &nnz)))
+    return ERR_FAIL;
+  if (!s21_line_end(p) || rows < 1 || cols < 1 || rows >= INT32_MAX ||
+      cols >= INT32_MAX || (t->symmetry && rows != cols))
+    return ERR_FAIL;
+  *m = (int)rows, *n = (int)cols, *expect = nnz;
+  if (t->kind == S21_TEXT_ARRAY && t->symmetry == S21_GENERAL)
+    *expect = rows * cols;
+  else if (t->kind == S21_TEXT_ARRAY)
+    *expect = rows * (rows + (t->symmetry == S21_SKEW ? -1 : 1)) / 2;
+  return OK;
+}
+
+int s21_parse_matrix(const char *text, matrix_t *result) {
+  S21_STAT(S21_OP_IO, 0);
+  if (!text || !result) return ERR_FAIL;
+  s21_parse_t t = {.kind = S21_TEXT_CSV, .A = result};
+  int mm = !strncasecmp(text, BANNER, strlen(BANNER)), m = 0, n = 0;
+  if (mm && s21_banner(text, &t)) return ERR_FAIL;
+  const char **line;
+  int lines;
+  if (s21_index_lines(text, mm, &line, &lines)) return ERR_FAIL;
+  long expect;
+  int status = lines && !s21_shape(&t, line, lines, &m, &n, &expect) &&
+                       expect == lines - mm
+                   ? OK
+                   : ERR_FAIL;
+  if (!status) status = s21_create_matrix(m, n, result) ? ERR_FAIL : OK;
+  t.line = line + mm, t.lines = lines - mm;
+  if (!status && (status = s21_parse_run(&t, strlen(text))))
+    s21_remove_matrix(result);
+  free(line);
+  return status;
+}
+
+// the whole file in one buffer, parsed in place
+int s21_load_matrix(const char *path, matrix_t *result) {
+  S21_STAT(S21_OP_IO, 0);
+  if (!path || !result) return ERR_FAIL;
+  FILE *f = fopen(path, "rb");
+  if (!f) return ERR_FAIL;
+  char *text = NULL;
+  long size = fseek(f, 0, SEEK_END) ? -1 : ftell(f);
+  if (size >= 0 && !fseek(f, 0, SEEK_SET)) text = malloc(size + 1);
+  int status = text && fread(text, 1, size, f) == (size_t)size ? OK : ERR_FAIL;
+  fclose(f);
+  if (!status) text[size] = '\0', status = s21_parse_matrix(text, result);
+  free(text);
+  return status;
+}
+
+// shortest of %.15g, %.16g and %.17g that reads back as v
+static int s21_format_double(double v, char *buf) {
+  int len = 0;
+  for (int digits = 15; digits <= 17; digits++) {
+    len = snprintf(buf, FIELD, "%.*g", digits, v);
+    double back;
+    if (!is_fin(v) || (s21_parse_double(buf, &back) && back == v)) break;
+  }
+  return len;
+}
+
+// streams one formatted row (array: column) at a time
+static int s21_write_matrix(FILE *f, matrix_t *A, int format) {
+  int m = A->rows, n = A->columns;
+  char *buf = malloc((size_t)(m > n ? m : n) * FIELD * 2 + 64);
+  if (!buf) return ERR_FAIL;
+  long long nnz = 0;
+  if (format == S21_FMT_MM_COORD) FORS(m, n) nnz += A->matrix[i][j] != 0;
+  if (format == S21_FMT_MM_ARRAY)
+    fprintf(f, "%s matrix array real general\n%d %d\n", BANNER, m, n);
+  if (format == S21_FMT_MM_COORD)
+    fprintf(f, "%s matrix coordinate real general\n%d %d %lld\n", BANNER, m,
+            n, nnz);
+  for (int o = 0; o < (format == S21_FMT_MM_ARRAY ? n : m); o++) {
+    size_t len = 0;
+    for (int k = 0; k < (format == S21_FMT_MM_ARRAY ? m : n); k++) {
+      double v =
+          format == S21_FMT_MM_ARRAY ? A->matrix[k][o] : A->matrix[o][k];
+      if (format == S21_FMT_MM_COORD && v == 0) continue;
+      if (format == S21_FMT_MM_COORD)
+        len += snprintf(buf + len, FIELD, "%d %d ", o + 1, k + 1);
+      len += s21_format_double(v, buf + len);
+      buf[len++] = format == S21_FMT_CSV && k < n - 1 ? ',' : '\n';
+    }
+    if (len && fwrite(buf, 1, len, f) != len) break;
+  }
+  free(buf);
+  return ferror(f) ? ERR_FAIL : OK;
+}
+
+int s21_save_matrix(const char *path, matrix_t *A, int format) {
+  S21_STAT(S21_OP_IO, 0);
+  if (!path || !s21_m_valid(A)) return ERR_FAIL;
+  if (format < S21_FMT_CSV || format > S21_FMT_MM_COORD) return ERR_FAIL;
+  FILE *f = fopen(path, "w");
+  if (!f) return ERR_FAIL;
+  int status = s21_write_matrix(f, A, format);
+  return fclose(f) ? ERR_FAIL : status;
+}
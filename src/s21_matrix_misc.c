@@ -1,11 +1,29 @@
+#include <stdatomic.h>
+
 #include "s21_matrix.h"
 
+#define FLOPS_A(x) (s21_m_valid(A) ? (x) : 0)
+#define COFACTOR_FLOPS(n) s21_expansion_flops(n, NULL)
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
 //=================   MISCELLANEOUS   ======================
 
 int s21_transpose(M_ARES) {
+  S21_STAT(S21_OP_TRANSPOSE, 0);
   if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  s21_plan_t plan;
+  s21_plan(S21_OP_TRANSPOSE, A, NULL, &plan);
   s21_create_matrix(A->columns, A->rows, result);
-  FORS(A->rows, A->columns) result->matrix[j][i] = A->matrix[i][j];
+  if (plan.algo != S21_ALGO_BLOCKED) {
+    FORS(A->rows, A->columns) result->matrix[j][i] = A->matrix[i][j];
+    return OK;
+  }
+  int bs = plan.block;  // tiles keep both sides of the copy in cache
+  for (int ii = 0; ii < A->rows; ii += bs)
+    for (int jj = 0; jj < A->columns; jj += bs)
+      for (int i = ii; i < MIN(ii + bs, A->rows); i++)
+        for (int j = jj; j < MIN(jj + bs, A->columns); j++)
+          result->matrix[j][i] = A->matrix[i][j];
   return OK;
 }
 
@@ -28,9 +46,25 @@ matrix_t *s21_create_minor(int ex_rows, int ex_columns, matrix_t *A) {
   free(minor);              \
   minor = NULL;
 
+// cofactor results for any n; LU rounds differently, so it stays opt-in
+// through s21_lu_determinant and s21_lu_inverse
 int s21_determinant(M_ADRES) {
+  s21_plan_t plan;
+  int status = s21_plan(S21_OP_DETERMINANT, A, NULL, &plan);
+  if (!status && result && plan.algo == S21_ALGO_TRIANGULAR) {
+    double det = 1;
+    FOR(A->rows) det *= A->matrix[i][i];
+    *result = det;
+    return OK;
+  }
+  return s21_determinant_ex(A, result, NULL);
+}
+
+int s21_determinant_ex(M_ADRES, s21_cancel_t *token) {
+  S21_STAT(S21_OP_DETERMINANT, FLOPS_A(COFACTOR_FLOPS(A->rows)));
   if (!s21_m_valid(A) || !result) return ERR_FAIL;
   if (!s21_check_square(A)) return ERR_CALC;
+  if (A->rows > 2 && s21_cancelled(token)) return ERR_CANCEL;
 
   double det = 0, det_temp = 0;
   if (A->rows == 1)
@@ -42,40 +76,86 @@ int s21_determinant(M_ADRES) {
     FOR(A->rows) {
       int sign = (i % 2 == 0) ? 1 : -1;
       matrix_t *minor = s21_create_minor(0, i, A);
-      if (!minor || s21_determinant(minor, &det_temp)) return ERR_FAIL;
-      det += sign * A->matrix[0][i] * det_temp;
+      int status =
+          minor ? s21_determinant_ex(minor, &det_temp, token) : ERR_FAIL;
       FREEMINOR
+      if (status) return status == ERR_CANCEL ? ERR_CANCEL : ERR_FAIL;
+      det += sign * A->matrix[0][i] * det_temp;
       *result = det;
     }
   return OK;
 }
 
 int s21_calc_complements(matrix_t *A, matrix_t *result) {
+  s21_plan_t plan;
+  if (!s21_plan(S21_OP_COMPLEMENTS, A, NULL, &plan) &&
+      plan.algo == S21_ALGO_THREADED)
+    return s21_calc_complements_mt(A, result, plan.threads, NULL);
+  return s21_calc_complements_ex(A, result, NULL);
+}
+
+int s21_calc_complements_ex(M_ARES, s21_cancel_t *token) {
+  S21_STAT(S21_OP_COMPLEMENTS,
+           FLOPS_A(1.0 * A->rows * A->rows * COFACTOR_FLOPS(A->rows - 1)));
   if (!s21_m_valid(A) || !result) return ERR_FAIL;
   if (!s21_check_square(A)) return ERR_CALC;
 
   s21_create_matrix(A->rows, A->columns, result);
   FORS(A->rows, A->columns) {
+    if (s21_cancelled(token)) return s21_remove_matrix(result), ERR_CANCEL;
     matrix_t *minor = s21_create_minor(i, j, A);
     double det_temp = 0;
-    if (!minor || s21_determinant(minor, &det_temp)) return ERR_FAIL;
-    result->matrix[i][j] = pow(-1, i + j) * det_temp;
+    int status =
+        minor ? s21_determinant_ex(minor, &det_temp, token) : ERR_FAIL;
     FREEMINOR
+    if (status == ERR_CANCEL) return s21_remove_matrix(result), ERR_CANCEL;
+    if (status) return s21_remove_matrix(result), ERR_FAIL;
+    result->matrix[i][j] = pow(-1, i + j) * det_temp;
   }
   return OK;
 }
 
+// substitution against the identity on a compact copy of the triangle
+static int s21_triangular_inverse(M_ARES) {
+  S21_STAT(S21_OP_INVERSE, 1.0 * A->rows * A->rows * A->rows / 3);
+  int kl, ku;
+  s21_matrix_bandwidth(A, &kl, &ku);
+  s21_band_t T = {0};
+  matrix_t I = {0};
+  if (s21_band_from_matrix(A, kl, ku, &T) ||
+      s21_create_matrix(A->rows, A->rows, &I))
+    return s21_remove_band(&T), ERR_FAIL;
+  FOR(A->rows) I.matrix[i][i] = 1;
+  int status = s21_band_solve(&T, &I, result);
+  s21_remove_band(&T);
+  s21_remove_matrix(&I);
+  return status;
+}
+
 int s21_inverse_matrix(matrix_t *A, matrix_t *result) {
+  s21_plan_t plan;
+  int status = s21_plan(S21_OP_INVERSE, A, NULL, &plan);
+  if (!status && result && plan.algo == S21_ALGO_TRIANGULAR)
+    return s21_triangular_inverse(A, result);
+  return s21_inverse_matrix_ex(A, result, NULL);
+}
+
+int s21_inverse_matrix_ex(M_ARES, s21_cancel_t *token) {
+  S21_STAT(S21_OP_INVERSE, FLOPS_A(1.0 * A->rows * A->columns));
   if (!s21_m_valid(A) || !result) return ERR_FAIL;
   if (!s21_check_square(A)) return ERR_CALC;
   double det = 0;
-  if (s21_determinant(A, &det) || det == 0) return ERR_CALC;
+  int status = s21_determinant_ex(A, &det, token);
+  if (status == ERR_CANCEL) return ERR_CANCEL;
+  if (status || det == 0) return ERR_CALC;
 
   matrix_t transspouse, adjoint;
-  int ok_adjoint = s21_calc_complements(A, &adjoint);
+  int ok_adjoint = s21_calc_complements_ex(A, &adjoint, token);
+  if (ok_adjoint == ERR_CANCEL) return ERR_CANCEL;
   if (ok_adjoint || !s21_m_valid(&adjoint)) return ERR_CALC;
   int ok_transspouse = s21_transpose(&adjoint, &transspouse);
-  if (ok_transspouse || !s21_m_valid(&transspouse)) return ERR_CALC;
+  if (ok_transspouse || !s21_m_valid(&transspouse))
+    return s21_remove_matrix(&adjoint), ERR_CALC;
 
   s21_create_matrix(A->rows, A->columns, result);
   FORS(A->rows, A->columns) {
@@ -86,3 +166,106 @@ int s21_inverse_matrix(matrix_t *A, matrix_t *result) {
 
   return OK;
 }
+
+//=============   PARALLEL COFACTORS   =====================
+
+typedef struct {
+  double *a, *out, *arena;
+  int n;
+  size_t arena_size;
+  s21_cancel_t *token;
+  atomic_int stopped;
+} s21_cofactor_t;
+
+static void s21_flat_minor(const double *a, int n, int er, int ec, double *m) {
+  FORS(n, n) if (i != er && j != ec) *m++ = a[i * n + j];
+}
+
+// s21_determinant expression for expression, minors live in a flat arena;
+// the token is polled once per expansion of 4x4 and larger
+static int s21_det_flat(const double *a, int n, double *arena,
+                        s21_cancel_t *token, double *result) {
+  if (n == 1) return *result = a[0], OK;
+  if (n == 2) return *result = a[0] * a[3] - a[1] * a[2], OK;
+  if (n > 3 && s21_cancelled(token)) return ERR_CANCEL;
+  double det = 0, det_temp = 0;
+  FOR(n) {
+    int sign = (i % 2 == 0) ? 1 : -1;
+    s21_flat_minor(a, n, 0, i, arena);
+    double *next = arena + (n - 1) * (n - 1);
+    if (s21_det_flat(arena, n - 1, next, token, &det_temp)) return ERR_CANCEL;
+    det += sign * a[i] * det_temp;
+  }
+  return *result = det, OK;
+}
+
+static void s21_cofactor_task(void *ctx, int task, int tid) {
+  s21_cofactor_t *c = ctx;
+  if (atomic_load_explicit(&c->stopped, memory_order_relaxed)) return;
+  int m = c->n - 1, i = task / c->n, j = task % c->n;
+  double *arena = c->arena + tid * c->arena_size;
+  s21_flat_minor(c->a, c->n, i, j, arena);
+  if (s21_det_flat(arena, m, arena + m * m, c->token, &c->out[task]))
+    atomic_store(&c->stopped, 1);  // the remaining tasks return at once
+}
+
+// flat copy of A, n^2 outputs and one arena of sum(k^2, k < n) per thread
+static int s21_cofactor_init(M_A, int tasks, int threads, s21_cancel_t *token,
+                             s21_cofactor_t *c) {
+  int n = A->rows;
+  *c = (s21_cofactor_t){.n = n, .token = token};
+  atomic_init(&c->stopped, 0);
+  c->arena_size = (size_t)(n - 1) * n * (2 * n - 1) / 6;
+  c->a = malloc(sizeof(double) * n * n);
+  c->out = malloc(sizeof(double) * tasks);
+  c->arena = malloc(sizeof(double) * c->arena_size *
+                    s21_thread_count(threads, tasks));
+  if (!c->a || !c->out || !c->arena)
+    return free(c->a), free(c->out), free(c->arena), ERR_FAIL;
+  FORS(n, n) c->a[i * n + j] = A->matrix[i][j];
+  return OK;
+}
+
+#define FREECOFACTOR free(c.a), free(c.out), free(c.arena)
+
+int s21_determinant_mt(M_ADRES, int threads, s21_cancel_t *token) {
+  S21_STAT(S21_OP_DETERMINANT, FLOPS_A(COFACTOR_FLOPS(A->rows)));
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (!s21_check_square(A)) return ERR_CALC;
+  if (A->rows < 3) return s21_determinant_ex(A, result, NULL);
+
+  s21_cofactor_t c;
+  if (s21_cofactor_init(A, A->rows, threads, token, &c)) return ERR_FAIL;
+  int status = s21_parallel_for(A->rows, threads, s21_cofactor_task, &c);
+  if (!status && atomic_load(&c.stopped)) status = ERR_CANCEL;
+  if (status) return FREECOFACTOR, status;
+  double det = 0;
+  FOR(A->rows) {  // first-row expansion, summed in the serial order
+    int sign = (i % 2 == 0) ? 1 : -1;
+    det += sign * A->matrix[0][i] * c.out[i];
+  }
+  *result = det;
+  FREECOFACTOR;
+  return OK;
+}
+
+int s21_calc_complements_mt(M_ARES, int threads, s21_cancel_t *token) {
+  S21_STAT(S21_OP_COMPLEMENTS,
+           FLOPS_A(1.0 * A->rows * A->rows * COFACTOR_FLOPS(A->rows - 1)));
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (!s21_check_square(A)) return ERR_CALC;
+  if (A->rows == 1) return ERR_FAIL;  // no 0x0 minor, as in the serial path
+
+  s21_cofactor_t c;
+  int tasks = A->rows * A->columns;
+  if (s21_cofactor_init(A, tasks, threads, token, &c)) return ERR_FAIL;
+  int status = s21_parallel_for(tasks, threads, s21_cofactor_task, &c);
+  if (!status && atomic_load(&c.stopped)) status = ERR_CANCEL;
+  if (status) return FREECOFACTOR, status;
+  if (!!s21_create_matrix(A->rows, A->columns, result))
+    return FREECOFACTOR, ERR_FAIL;
+  FORS(A->rows, A->columns)
+  result->matrix[i][j] = pow(-1, i + j) * c.out[i * A->columns + j];
+  FREECOFACTOR;
+  return OK;
+}
@@ -0,0 +1,378 @@
+#include <ctype.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+//====================   TUNING   ==========================
+
+static const s21_tuning_t s21_tuning_stock = {.small_max = 16,
+                                              .block = 64,
+                                              .transpose_block = 32,
+                                              .threaded_flops = 2e7,
+                                              .threads = 0,
+                                              .strassen_min = 2048,
+                                              .strassen_leaf = 128,
+                                              .complements_mt_min = 8,
+                                              .accumulate = S21_ACC_FAST,
+                                              .qr_block = 32};
+
+static s21_tuning_t s21_tuning;
+static pthread_mutex_t s21_tuning_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t s21_tuning_once = PTHREAD_ONCE_INIT;
+
+#define KEY_INT(k) {#k, offsetof(s21_tuning_t, k), 0}
+#define KEY_DBL(k) {#k, offsetof(s21_tuning_t, k), 1}
+
+static const struct {
+  const char *name;
+  size_t offset;
+  int is_double;
+} s21_tuning_keys[] = {KEY_INT(small_max),
+                       KEY_INT(block),
+                       KEY_INT(transpose_block),
+                       KEY_DBL(threaded_flops),
+                       KEY_INT(threads),
+                       KEY_INT(strassen_min),
+                       KEY_INT(strassen_leaf),
+                       KEY_INT(complements_mt_min),
+                       KEY_INT(accumulate),
+                       KEY_INT(qr_block)};
+
+#define NKEYS (int)(sizeof(s21_tuning_keys) / sizeof(s21_tuning_keys[0]))
+#define FIELD(t, i, type) ((type *)((char *)(t) + s21_tuning_keys[i].offset))
+
+// keeps the planner away from sizes it cannot work with
+static void s21_tuning_clamp(s21_tuning_t *t) {
+  if (t->small_max < 0) t->small_max = 0;
+  if (t->block < 4) t->block = 4;
+  if (t->transpose_block < 4) t->transpose_block = 4;
+  if (t->threads < 0) t->threads = 0;
+  if (t->strassen_leaf < 8) t->strassen_leaf = 8;
+  if (t->strassen_min < 2 * t->strassen_leaf)
+    t->strassen_min = 2 * t->strassen_leaf;
+  if (t->accumulate < S21_ACC_FAST || t->accumulate > S21_ACC_DOT2)
+    t->accumulate = S21_ACC_FAST;
+  if (t->qr_block < 1) t->qr_block = 1;
+}
+
+static int s21_tuning_parse(FILE *f, s21_tuning_t *t) {
+  char line[256], key[64];
+  double value;
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, " %63[a-z_] = %lf", key, &value) != 2) continue;
+    FOR(NKEYS) if (!strcmp(key, s21_tuning_keys[i].name)) {
+      if (s21_tuning_keys[i].is_double)
+        *FIELD(t, i, double) = value;
+      else
+        *FIELD(t, i, int) = (int)value;
+    }
+  }
+  return ferror(f) ? ERR_CALC : OK;
+}
+
+static int s21_tuning_read(const char *path, s21_tuning_t *t) {
+  FILE *f = path ? fopen(path, "r") : NULL;
+  if (!f) return ERR_FAIL;
+  int status = s21_tuning_parse(f, t);
+  fclose(f);
+  s21_tuning_clamp(t);
+  return status;
+}
+
+// CPU model name with everything but letters and digits folded to '_'
+static void s21_cpu_model(char *buf, size_t size) {
+  char line[256], *name = NULL;
+  FILE *f = fopen("/proc/cpuinfo", "r");
+  while (f && !name && fgets(line, sizeof(line), f))
+    if (!strncmp(line, "model name", 10) || !strncmp(line, "Model", 5))
+      name = strchr(line, ':');
+  if (f) fclose(f);
+  size_t n = 0;
+  for (char *c = name ? name + 1 : "generic"; *c && n + 1 < size; c++) {
+    int word = isalnum((unsigned char)*c);
+    if (word || (n && buf[n - 1] != '_')) buf[n++] = word ? *c : '_';
+  }
+  while (n && buf[n - 1] == '_') n--;
+  buf[n] = '\0';
+}
+
+// $XDG_CACHE_HOME (or ~/.cache)/s21_matrix/<cpu model>.conf, snprintf-like
+int s21_tuning_path(char *buf, size_t size) {
+  const char *cache = getenv("XDG_CACHE_HOME"), *home = getenv("HOME");
+  char model[128];
+  s21_cpu_model(model, sizeof(model));
+  int n = -1;
+  if (cache && *cache)
+    n = snprintf(buf, size, "%s/s21_matrix/%s.conf", cache, model);
+  else if (home && *home)
+    n = snprintf(buf, size, "%s/.cache/s21_matrix/%s.conf", home, model);
+  return n;
+}
+
+// an explicit S21_MATRIX_PROFILE wins over the per-CPU autotune cache
+static void s21_tuning_boot(void) {
+  s21_tuning = s21_tuning_stock;
+  char path[512];
+  const char *env = getenv("S21_MATRIX_PROFILE");
+  int n = s21_tuning_path(path, sizeof(path));
+  if (env)
+    s21_tuning_read(env, &s21_tuning);
+  else if (n > 0 && (size_t)n < sizeof(path))
+    s21_tuning_read(path, &s21_tuning);
+}
+
+void s21_tuning_defaults(s21_tuning_t *out) {
+  if (out) *out = s21_tuning_stock;
+}
+
+void s21_tuning_get(s21_tuning_t *out) {
+  if (!out) return;
+  pthread_once(&s21_tuning_once, s21_tuning_boot);
+  pthread_mutex_lock(&s21_tuning_lock);
+  *out = s21_tuning;
+  pthread_mutex_unlock(&s21_tuning_lock);
+}
+
+void s21_tuning_set(const s21_tuning_t *in) {
+  pthread_once(&s21_tuning_once, s21_tuning_boot);
+  s21_tuning_t t = in ? *in : s21_tuning_stock;
+  s21_tuning_clamp(&t);
+  pthread_mutex_lock(&s21_tuning_lock);
+  s21_tuning = t;
+  pthread_mutex_unlock(&s21_tuning_lock);
+}
+
+// keys missing from the file keep their current values
+int s21_tuning_load(const char *path) {
+  s21_tuning_t t;
+  s21_tuning_get(&t);
+  int status = s21_tuning_read(path, &t);
+  if (!status) s21_tuning_set(&t);
+  return status;
+}
+
+int s21_tuning_save(const char *path) {
+  s21_tuning_t t;
+  s21_tuning_get(&t);
+  FILE *f = path ? fopen(path, "w") : NULL;
+  if (!f) return ERR_FAIL;
+  FOR(NKEYS) {
+    const char *key = s21_tuning_keys[i].name;
+    if (s21_tuning_keys[i].is_double)
+      fprintf(f, "%s = %.17g\n", key, *FIELD(&t, i, double));
+    else
+      fprintf(f, "%s = %d\n", key, *FIELD(&t, i, int));
+  }
+  return fclose(f) ? ERR_CALC : OK;
+}
+
+//====================   PLANNER   =========================
+
+static const char *const s21_algo_names[] = {
+    "naive", "small",    "blocked", "threaded",
+    "strassen", "cofactor", "lu",   "triangular"};
+
+const char *s21_algo_name(s21_algo_t algo) {
+  return algo >= S21_ALGO_NAIVE && algo <= S21_ALGO_TRIANGULAR
+             ? s21_algo_names[algo]
+             : "unknown";
+}
+
+#define D 8.0  // bytes per element
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define CEIL(a, b) (((a) + (b)-1) / (b))
+
+// multiply-adds of the first-row expansion, minors are copied per level
+double s21_expansion_flops(int n, double *scratch) {
+  double flops = 0, bytes = 0;
+  for (int k = 3; k <= n; k++) flops = k * (flops + 3), bytes += D * k * k;
+  if (n == 2) flops = 3;
+  if (scratch) *scratch = bytes;
+  return flops;
+}
+
+// padded edge of the Strassen recursion and its depth
+static int s21_strassen_edge(int n, int leaf, int *levels) {
+  int l = 0;
+  while (CEIL(n, 1 << l) > leaf) l++;
+  if (levels) *levels = l;
+  return CEIL(n, 1 << l) << l;
+}
+
+static void s21_plan_mult(const s21_tuning_t *t, int m, int k, int n,
+                          s21_plan_t *p) {
+  p->flops = 2.0 * m * k * n;
+  p->block = t->block;
+  p->accumulate = t->accumulate;
+  int lo = MIN(m, MIN(k, n)), hi = MAX(m, MAX(k, n));
+  if (hi <= t->small_max && !t->accumulate) {
+    p->algo = S21_ALGO_SMALL;
+    p->bytes = D * ((double)m * k + (double)m * k * n + (double)m * n);
+  } else if (lo >= t->strassen_min && hi <= 2 * lo && !t->accumulate) {
+    int levels, e = s21_strassen_edge(hi, t->strassen_leaf, &levels);
+    double leaf = (double)e / (1 << levels), adds = 0, mults = 1;
+    for (int l = 0; l < levels; l++, mults *= 7)
+      adds += mults * 18.0 * (e >> (l + 1)) * (e >> (l + 1));
+    p->algo = S21_ALGO_STRASSEN;
+    p->flops = mults * 2.0 * leaf * leaf * leaf + adds;
+    p->scratch = D * 4.0 * e * e;
+    p->bytes = D * (3.0 * e * e + 5.0 * adds);
+  } else {
+    p->threads = s21_thread_count(t->threads, m);
+    p->algo = p->threads > 1 && p->flops >= t->threaded_flops
+                  ? S21_ALGO_THREADED
+                  : S21_ALGO_BLOCKED;
+    if (p->algo != S21_ALGO_THREADED) p->threads = 1;
+    p->bytes = D * ((double)m * k + (double)k * n * CEIL(m, t->block) +
+                    (double)m * n * CEIL(k, t->block));
+    int blocks = CEIL(k, t->block), depth = 2;
+    while (blocks >>= 1) depth++;
+    if (t->accumulate == S21_ACC_PAIRWISE) {  // a stack of partial rows
+      p->flops += (double)m * n * CEIL(k, t->block);
+      p->scratch = D * p->threads * depth * t->block;
+    } else if (t->accumulate == S21_ACC_DOT2) {  // 25 flops a term, 2 rows
+      p->flops *= 12.5;
+      p->scratch = D * p->threads * 2 * t->block;
+    }
+  }
+}
+
+static void s21_plan_square(const s21_tuning_t *t, s21_op_t op, matrix_t *A,
+                            s21_plan_t *p) {
+  int n = A->rows, kl, ku;
+  double nn = (double)n * n, minors = 0;
+  p->threads = 1;
+  s21_matrix_bandwidth(A, &kl, &ku);
+  if (op != S21_OP_COMPLEMENTS && n > 1 && (!kl || !ku)) {
+    p->algo = S21_ALGO_TRIANGULAR;  // an O(n^2) scan found the structure
+    p->flops = op == S21_OP_INVERSE ? nn * n / 3 : n;
+    p->scratch = op == S21_OP_INVERSE ? D * nn / 2 : 0;
+    p->bytes = D * (op == S21_OP_INVERSE ? 2 : 1) * nn;
+  } else if (op == S21_OP_COMPLEMENTS) {
+    p->flops = nn * s21_expansion_flops(n - 1, &p->scratch);
+    p->bytes = D * 2 * nn;
+    p->threads = s21_thread_count(t->threads, n * n);
+    p->algo = p->threads > 1 && n >= t->complements_mt_min
+                  ? S21_ALGO_THREADED
+                  : S21_ALGO_COFACTOR;
+    if (p->algo == S21_ALGO_COFACTOR) p->threads = 1;
+  } else {
+    p->algo = S21_ALGO_COFACTOR;
+    p->flops = s21_expansion_flops(n, &p->scratch);
+    if (op == S21_OP_INVERSE) {  // determinant, complements, transpose
+      p->flops += nn * (s21_expansion_flops(n - 1, &minors) + 1);
+      p->scratch += D * 2 * nn + minors;
+    }
+    p->bytes = D * nn + p->scratch;
+  }
+}
+
+// one pass over A split into `tasks` independent parts
+static void s21_plan_pass(const s21_tuning_t *t, int tasks, s21_plan_t *p) {
+  p->threads = s21_thread_count(t->threads, tasks);
+  p->algo = p->threads > 1 && p->flops >= t->threaded_flops
+                ? S21_ALGO_THREADED
+                : S21_ALGO_BLOCKED;
+  if (p->algo != S21_ALGO_THREADED) p->threads = 1;
+}
+
+int s21_plan(s21_op_t op, matrix_t *A, matrix_t *B, s21_plan_t *plan) {
+  return s21_plan_ex(op, A, B, NULL, plan);
+}
+
+// plans against tuning instead of the process-wide thresholds (NULL)
+int s21_plan_ex(s21_op_t op, matrix_t *A, matrix_t *B,
+                const s21_tuning_t *tuning, s21_plan_t *plan) {
+  if (!plan || !s21_m_valid(A)) return ERR_FAIL;
+  int binary = op == S21_OP_SUM || op == S21_OP_SUB || op == S21_OP_MULT ||
+               op == S21_OP_CHOLESKY_SOLVE || op == S21_OP_LSTSQ ||
+               op == S21_OP_KRON;
+  if (binary && !s21_m_valid(B)) return ERR_FAIL;
+  s21_tuning_t t;
+  if (tuning)
+    t = *tuning, s21_tuning_clamp(&t);
+  else
+    s21_tuning_get(&t);
+  int m = A->rows, n = A->columns;
+  double mn = (double)m * n, nn = (double)n * n;
+  *plan = (s21_plan_t){.op = op, .algo = S21_ALGO_NAIVE, .threads = 1};
+
+  switch (op) {
+    case S21_OP_CREATE:
+      plan->bytes = D * mn;
+      break;
+    case S21_OP_SUM:
+    case S21_OP_SUB:
+      if (!s21_m_eqdim(A, B)) return ERR_CALC;
+      plan->flops = mn, plan->bytes = D * 3 * mn;
+      s21_plan_pass(&t, m, plan);
+      break;
+    case S21_OP_MULT_NUMBER:  // row bands, like sum and sub
+      plan->flops = mn, plan->bytes = D * 2 * mn;
+      s21_plan_pass(&t, m, plan);
+      break;
+    case S21_OP_MULT:
+      if (n != B->rows) return ERR_CALC;
+      s21_plan_mult(&t, m, n, B->columns, plan);
+      break;
+    case S21_OP_GEMV:  // rows split for y = A x, columns for A^T x
+      plan->flops = 2 * mn, plan->bytes = D * (mn + m + n);
+      s21_plan_pass(&t, MAX(m, n), plan);
+      break;
+    case S21_OP_REDUCE:  // row chunks, each with its own partial
+      plan->flops = mn, plan->bytes = D * mn;
+      s21_plan_pass(&t, m, plan);
+      break;
+    case S21_OP_EIGEN:  // tridiagonal reduction, trailing rows split
+      if (m != n) return ERR_CALC;
+      plan->flops = 2 * nn * n, plan->bytes = D * 2 * nn;
+      plan->scratch = D * (nn + 5.0 * n);
+      s21_plan_pass(&t, n, plan);
+      break;
+    case S21_OP_KRON:  // one row of A, so B->rows output rows, per task
+      plan->flops = mn * B->rows * B->columns, plan->bytes = D * plan->flops;
+      s21_plan_pass(&t, m, plan);
+      break;
+    case S21_OP_SVD:  // one Jacobi sweep, the pairs of a round split
+      plan->flops = 10 * mn * MIN(m, n), plan->bytes = D * 2 * mn;
+      plan->scratch = D * (mn + (double)MIN(m, n) * MIN(m, n));
+      s21_plan_pass(&t, MIN(m, n) / 2, plan);
+      break;
+    case S21_OP_TRANSPOSE:
+      plan->bytes = D * 2 * mn;
+      plan->block = t.transpose_block;
+      plan->algo = MAX(m, n) <= t.small_max ? S21_ALGO_SMALL : S21_ALGO_BLOCKED;
+      break;
+    case S21_OP_DETERMINANT:
+    case S21_OP_COMPLEMENTS:
+    case S21_OP_INVERSE:
+      if (m != n) return ERR_CALC;
+      s21_plan_square(&t, op, A, plan);
+      break;
+    case S21_OP_CHOLESKY:
+      if (m != n) return ERR_CALC;
+      plan->flops = nn * n / 3, plan->bytes = D * nn;
+      break;
+    case S21_OP_CHOLESKY_SOLVE:
+      if (m != n || B->rows != n) return ERR_CALC;
+      plan->flops = 2.0 * nn * B->columns;
+      plan->bytes = D * (nn + 2.0 * n * B->columns);
+      break;
+    case S21_OP_QR:
+    case S21_OP_LSTSQ:
+      if (m < n || (op == S21_OP_LSTSQ && B->rows != m)) return ERR_CALC;
+      plan->block = t.qr_block;
+      plan->flops = 4.0 * mn * n - 4.0 / 3 * nn * n;
+      plan->scratch = D * (mn + n + 2.0 * t.qr_block * MAX(m, t.qr_block));
+      plan->bytes = D * 3 * mn;
+      s21_plan_pass(&t, n, plan);  // trailing columns split per panel
+      break;
+    default:
+      return ERR_FAIL;
+  }
+  return OK;
+}
@@ -0,0 +1,127 @@
+#include <string.h>
+
+#include "s21_matrix.h"
+
+#define PADE_Q 6  // [6/6] is accurate to roundoff once ||X|| <= 1/2
+#define CUBE(n) (2.0 * (n) * (n) * (n))
+
+//=====================   POWERS   =========================
+
+static void s21_swap_matrix(matrix_t *a, matrix_t *b) {
+  matrix_t t = *a;
+  *a = *b, *b = t;
+}
+
+// c = a * b with the planned kernel, c is overwritten
+static int s21_mult_into(const s21_plan_t *plan, matrix_t *a, matrix_t *b,
+                         matrix_t *c) {
+  FOR(c->rows) memset(c->matrix[i], 0, sizeof(double) * c->columns);
+  return s21_gemm(plan, a, b, c);
+}
+
+#ifdef S21_STATS
+static double s21_pow_flops(matrix_t *A, long long k) {
+  if (!s21_m_valid(A)) return 0;
+  int mults = -2;  // squarings below the top bit, products after the first
+  for (unsigned long long e = k < 0 ? 0ULL - k : (unsigned long long)k; e;
+       e >>= 1)
+    mults += 1 + (e & 1);
+  return mults > 0 ? mults * CUBE(A->rows) : 0;
+}
+#endif
+
+// result = base^e, base is clobbered; the first factor is copied rather
+// than multiplied into the identity
+static int s21_pow_loop(matrix_t *base, unsigned long long e, matrix_t *tmp,
+                        matrix_t *result) {
+  s21_plan_t plan;
+  int status = s21_plan(S21_OP_MULT, base, base, &plan), unit = 1;
+  FOR(result->rows) result->matrix[i][i] = 1;
+  while (!status && e) {
+    if (e & 1 && unit) {
+      FORS(base->rows, base->columns)
+      result->matrix[i][j] = base->matrix[i][j];
+      unit = 0;
+    } else if (e & 1) {
+      status = s21_mult_into(&plan, result, base, tmp);
+      s21_swap_matrix(result, tmp);
+    }
+    if ((e >>= 1) && !status) {
+      status = s21_mult_into(&plan, base, base, tmp);
+      s21_swap_matrix(base, tmp);
+    }
+  }
+  return status;
+}
+
+int s21_matrix_pow(matrix_t *A, long long k, matrix_t *result) {
+  S21_STAT(S21_OP_POW, s21_pow_flops(A, k));
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (!s21_check_square(A)) return ERR_CALC;
+  int n = A->rows;
+  matrix_t base = {0}, tmp = {0};
+  *result = (matrix_t){0};
+  int status = k < 0 ? s21_lu_inverse(A, &base)
+                     : s21_create_matrix(n, n, &base) ? ERR_FAIL : OK;
+  if (status) return status;
+  if (k >= 0) FORS(n, n) base.matrix[i][j] = A->matrix[i][j];
+  if (s21_create_matrix(n, n, &tmp) || s21_create_matrix(n, n, result))
+    status = ERR_FAIL;
+  unsigned long long e = k < 0 ? 0ULL - k : (unsigned long long)k;
+  if (!status) status = s21_pow_loop(&base, e, &tmp, result);
+  if (status) s21_remove_matrix(result);
+  s21_remove_matrix(&base);
+  s21_remove_matrix(&tmp);
+  return status;
+}
+
+// e^A = (e^(A / 2^s))^(2^s) with 2^s >= 2 ||A||_inf, the inner exponential
+// from the diagonal [q/q] Pade approximant D^-1 N
+int s21_matrix_exp(M_ARES) {
+  S21_STAT(S21_OP_EXP, s21_m_valid(A) ? (PADE_Q + 8) * CUBE(A->rows) : 0);
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (!s21_check_square(A)) return ERR_CALC;
+  int n = A->rows, s = 0;
+  double norm;
+  if (s21_norm(A, S21_NORM_INF, &norm)) return ERR_FAIL;
+  if (!is_fin(norm)) return ERR_CALC;
+  if (norm > 0) frexp(norm, &s), s = s + 1 > 0 ? s + 1 : 0;
+
+  matrix_t X = {0}, P = {0}, T = {0}, D = {0}, F = {0};
+  *result = (matrix_t){0};
+  int status = s21_create_matrix(n, n, &X) || s21_create_matrix(n, n, &P) ||
+                       s21_create_matrix(n, n, &T) ||
+                       s21_create_matrix(n, n, &D) ||
+                       s21_create_matrix(n, n, result)
+                   ? ERR_FAIL
+                   : OK;
+  s21_plan_t plan;
+  if (!status) status = s21_plan(S21_OP_MULT, &X, &X, &plan);
+  if (!status) {
+    FORS(n, n) X.matrix[i][j] = P.matrix[i][j] = ldexp(A->matrix[i][j], -s);
+    FOR(n) result->matrix[i][i] = D.matrix[i][i] = 1;
+  }
+  double c = 1;
+  for (int k = 1; k <= PADE_Q && !status; k++) {  // P = X^k
+    if (k > 1) status = s21_mult_into(&plan, &X, &P, &T);
+    if (k > 1) s21_swap_matrix(&P, &T);
+    c *= (double)(PADE_Q - k + 1) / (k * (2 * PADE_Q - k + 1));
+    FORS(n, n) {
+      double v = c * P.matrix[i][j];
+      result->matrix[i][j] += v;
+      D.matrix[i][j] += k % 2 ? -v : v;
+    }
+  }
+  if (!status) status = s21_lu_solve(&D, result, &F);
+  if (!status) s21_remove_matrix(result), *result = F;
+  for (int k = 0; k < s && !status; k++) {
+    status = s21_mult_into(&plan, result, result, &T);
+    s21_swap_matrix(result, &T);
+  }
+  if (status) s21_remove_matrix(result);
+  s21_remove_matrix(&X);
+  s21_remove_matrix(&P);
+  s21_remove_matrix(&T);
+  s21_remove_matrix(&D);
+  return status;
+}
@@ -0,0 +1,125 @@
+#include <limits.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+//====================   PRODUCTS   ========================
+
+#define HADAMARD(x, y) ((x) * (y))
+#define QUOTIENT(x, y) ((x) / (y))
+
+// element-wise kernels over one row, vectorizable as written
+#define S21_ROWWISE(name, op)                                    \
+  S21_CLONES static void name(double *restrict out,              \
+                              const double *restrict a,          \
+                              const double *restrict b, int n) { \
+    for (int j = 0; j < n; j++) out[j] = op(a[j], b[j]);         \
+  }
+
+S21_ROWWISE(s21_hadamard_row, HADAMARD)
+S21_ROWWISE(s21_quotient_row, QUOTIENT)
+
+// out[j] = a * b[j]: one row of an outer or Kronecker product
+S21_CLONES static void s21_scale_row(double *restrict out, double a,
+                                     const double *restrict b, int n) {
+  for (int j = 0; j < n; j++) out[j] = a * b[j];
+}
+
+int s21_hadamard(M_ABRES) {
+  S21_STAT(S21_OP_HADAMARD, s21_m_valid(A) ? (double)A->rows * A->columns : 0);
+  if (!s21_m_valid(A) || !s21_m_valid(B) || !result) return ERR_FAIL;
+  if (!s21_m_eqdim(A, B)) return ERR_CALC;
+  if (s21_create_matrix(A->rows, A->columns, result)) return ERR_FAIL;
+  FOR(A->rows)
+  s21_hadamard_row(result->matrix[i], A->matrix[i], B->matrix[i], A->columns);
+  return OK;
+}
+
+// ERR_CALC on a zero divisor, before anything is allocated
+int s21_hadamard_div(M_ABRES) {
+  S21_STAT(S21_OP_HADAMARD, s21_m_valid(A) ? (double)A->rows * A->columns : 0);
+  if (!s21_m_valid(A) || !s21_m_valid(B) || !result) return ERR_FAIL;
+  if (!s21_m_eqdim(A, B)) return ERR_CALC;
+  FORS(B->rows, B->columns) if (B->matrix[i][j] == 0) return ERR_CALC;
+  if (s21_create_matrix(A->rows, A->columns, result)) return ERR_FAIL;
+  FOR(A->rows)
+  s21_quotient_row(result->matrix[i], A->matrix[i], B->matrix[i], A->columns);
+  return OK;
+}
+
+int s21_outer(s21_vector_t *x, s21_vector_t *y, matrix_t *result) {
+  S21_STAT(S21_OP_KRON, x && y ? (double)x->size * y->size : 0);
+  if (!x || !x->data || !y || !y->data || !result) return ERR_FAIL;
+  if (s21_create_matrix(x->size, y->size, result)) return ERR_FAIL;
+  FOR(x->size)
+  s21_scale_row(result->matrix[i], x->data[i], y->data, y->size);
+  return OK;
+}
+
+typedef struct {
+  matrix_t *A, *B, *result;
+} s21_kron_t;
+
+// rows i * mb .. i * mb + mb - 1 of A (x) B, one row of A per task
+static void s21_kron_rows(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_kron_t *k = ctx;
+  int mb = k->B->rows, nb = k->B->columns;
+  FOR(mb) {
+    double *out = k->result->matrix[task * mb + i];
+    for (int j = 0; j < k->A->columns; j++)
+      s21_scale_row(out + j * nb, k->A->matrix[task][j], k->B->matrix[i], nb);
+  }
+}
+
+// ERR_CALC when either dimension of A (x) B exceeds INT_MAX
+int s21_kron(M_ABRES) {
+  S21_STAT(S21_OP_KRON, s21_m_valid(A) && s21_m_valid(B)
+                            ? (double)A->rows * A->columns * B->rows *
+                                  B->columns
+                            : 0);
+  if (!s21_m_valid(A) || !s21_m_valid(B) || !result) return ERR_FAIL;
+  if ((long long)A->rows * B->rows > INT_MAX ||
+      (long long)A->columns * B->columns > INT_MAX)
+    return ERR_CALC;
+  s21_plan_t plan;
+  s21_plan(S21_OP_KRON, A, B, &plan);
+  if (s21_create_matrix(A->rows * B->rows, A->columns * B->columns, result))
+    return ERR_FAIL;
+  s21_kron_t k = {A, B, result};
+  int status = OK;
+  if (plan.threads > 1)
+    status = s21_parallel_for(A->rows, plan.threads, s21_kron_rows, &k);
+  else
+    FOR(A->rows) s21_kron_rows(&k, i, 0);
+  if (status) s21_remove_matrix(result);
+  return status;
+}
+
+// y = (A (x) B) x without forming the product: with x read row-major as
+// X (na x nb), y is A X B^T row-major, (na nb mb + ma na mb) multiplies
+int s21_kron_apply(M_AB, s21_vector_t *x, s21_vector_t *y) {
+  S21_STAT(S21_OP_KRON, s21_m_valid(A) && s21_m_valid(B)
+                            ? 2.0 * A->columns * B->rows *
+                                  ((double)B->columns + A->rows)
+                            : 0);
+  if (!s21_m_valid(A) || !s21_m_valid(B)) return ERR_FAIL;
+  if (!x || !x->data || !y || !y->data) return ERR_FAIL;
+  if (x->size != (long long)A->columns * B->columns ||
+      y->size != (long long)A->rows * B->rows)
+    return ERR_CALC;
+  if (x->data == y->data) return ERR_CALC;
+  matrix_t X = {0}, Bt = {0}, XBt = {0}, Y = {0};
+  int status = s21_wrap_matrix(x->data, A->columns, B->columns, 0,
+                               S21_WRAP_BORROW, &X);
+  if (!status) status = s21_transpose(B, &Bt) ? ERR_FAIL : OK;
+  if (!status) status = s21_mult_matrix(&X, &Bt, &XBt) ? ERR_FAIL : OK;
+  if (!status) status = s21_mult_matrix(A, &XBt, &Y) ? ERR_FAIL : OK;
+  size_t bytes = sizeof(double) * B->rows;
+  if (!status) FOR(A->rows) memcpy(y->data + i * B->rows, Y.matrix[i], bytes);
+  s21_remove_matrix(&X);
+  s21_remove_matrix(&Bt);
+  s21_remove_matrix(&XBt);
+  s21_remove_matrix(&Y);
+  return status;
+}
@@ -0,0 +1,209 @@
+#include <float.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+#define CHUNK 64  // rows per partial, fixed so the combine order is too
+#define LANES 4
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define BIG 0x1p600  // Frobenius rescale when the plain sum over/underflows
+
+//===================   REDUCTIONS   =======================
+
+enum { R_ROWS, R_ROW_ABS, R_SQUARES, R_COLUMNS, R_ABS_COLUMNS, R_MIN_MAX };
+
+// sum of term(a[j]) in LANES interleaved sums, vectorizable as written
+#define S21_LANES(name, term)                                       \
+  S21_CLONES static double name(const double *restrict a, int n,    \
+                                double s) {                         \
+    double acc[LANES] = {0};                                        \
+    int j = 0;                                                      \
+    for (; j + LANES <= n; j += LANES)                              \
+      for (int l = 0; l < LANES; l++) acc[l] += term(a[j + l], s);  \
+    double r = (acc[0] + acc[1]) + (acc[2] + acc[3]);               \
+    for (; j < n; j++) r += term(a[j], s);                          \
+    return r;                                                       \
+  }
+#define PLAIN(x, s) ((void)(s), (x))
+#define ABS(x, s) ((void)(s), fabs(x))
+#define SQUARE(x, s) ((x) * (s) * ((x) * (s)))
+
+S21_LANES(s21_lanes_sum, PLAIN)
+S21_LANES(s21_lanes_abs, ABS)
+S21_LANES(s21_lanes_squares, SQUARE)
+
+typedef struct {
+  matrix_t *A;
+  double *part, *out, scale;
+  int kind, width;
+} s21_reduce_t;
+
+// running maximum that keeps the first NaN it meets
+static double s21_max_nan(double m, double v) {
+  return is_nan(v) || v > m ? v : m;
+}
+
+S21_CLONES static void s21_reduce_chunk(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_reduce_t *r = ctx;
+  int n = r->A->columns, lo = task * CHUNK;
+  int hi = MIN(r->A->rows, lo + CHUNK);
+  double **a = r->A->matrix, *restrict p = r->part + (size_t)task * r->width;
+  switch (r->kind) {
+    case R_ROWS:
+      for (int i = lo; i < hi; i++) r->out[i] = s21_lanes_sum(a[i], n, 1);
+      break;
+    case R_ROW_ABS:
+      for (int i = lo; i < hi; i++)
+        p[0] = s21_max_nan(p[0], s21_lanes_abs(a[i], n, 1));
+      break;
+    case R_SQUARES:
+      for (int i = lo; i < hi; i++)
+        p[0] += s21_lanes_squares(a[i], n, r->scale);
+      break;
+    case R_COLUMNS:
+    case R_ABS_COLUMNS:
+      for (int i = lo; i < hi; i++) {
+        const double *restrict ai = a[i];
+        if (r->kind == R_COLUMNS)
+          for (int j = 0; j < n; j++) p[j] += ai[j];
+        else
+          for (int j = 0; j < n; j++) p[j] += fabs(ai[j]);
+      }
+      break;
+    default: {  // R_MIN_MAX: min, max, max |a|, NaN count
+      double lo_v = INFINITY, hi_v = -INFINITY, abs_v = 0, nans = 0;
+      for (int i = lo; i < hi; i++)
+        for (int j = 0; j < n; j++) {
+          double v = a[i][j];
+          lo_v = v < lo_v ? v : lo_v;
+          hi_v = v > hi_v ? v : hi_v;
+          abs_v = fabs(v) > abs_v ? fabs(v) : abs_v;
+          nans += v != v;
+        }
+      p[0] = lo_v, p[1] = hi_v, p[2] = abs_v, p[3] = nans;
+    }
+  }
+}
+
+// fills r->part with one zeroed slice of r->width per chunk and runs
+// every chunk; the caller frees r->part
+static int s21_reduce(s21_reduce_t *r, int *chunks) {
+  *chunks = (r->A->rows + CHUNK - 1) / CHUNK;
+  r->part = calloc((size_t)*chunks * r->width + 1, sizeof(double));
+  if (!r->part) return ERR_FAIL;
+  s21_plan_t plan;
+  s21_plan(S21_OP_REDUCE, r->A, NULL, &plan);
+  if (plan.threads > 1)
+    return s21_parallel_for(*chunks, plan.threads, s21_reduce_chunk, r);
+  FOR(*chunks) s21_reduce_chunk(r, i, 0);
+  return OK;
+}
+
+// column partials of every chunk folded into the first, in chunk order
+static void s21_fold(s21_reduce_t *r, int chunks) {
+  for (int c = 1; c < chunks; c++)
+    for (int j = 0; j < r->width; j++)
+      r->part[j] += r->part[(size_t)c * r->width + j];
+}
+
+static int s21_squares(matrix_t *A, double scale, double *sum) {
+  s21_reduce_t r = {.A = A, .kind = R_SQUARES, .width = 1, .scale = scale};
+  int chunks, status = s21_reduce(&r, &chunks);
+  *sum = 0;
+  if (!status) FOR(chunks) *sum += r.part[i];
+  free(r.part);
+  return status;
+}
+
+// plain sum of squares, redone at a power-of-two scale when it overflows
+// or underflows
+static int s21_frobenius(matrix_t *A, double *result) {
+  double scale = 1, sum;
+  int status = s21_squares(A, scale, &sum);
+  if (!status && (is_inf(sum) || sum < DBL_MIN)) {
+    scale = is_inf(sum) ? 1 / BIG : BIG;
+    status = s21_squares(A, scale, &sum);
+  }
+  if (!status) *result = sqrt(sum) / scale;
+  return status;
+}
+
+int s21_norm(matrix_t *A, int kind, double *result) {
+  S21_STAT(S21_OP_REDUCE, s21_m_valid(A) ? (double)A->rows * A->columns : 0);
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (kind < S21_NORM_1 || kind > S21_NORM_MAX) return ERR_FAIL;
+  if (kind == S21_NORM_FRO) return s21_frobenius(A, result);
+
+  s21_reduce_t r = {.A = A, .kind = R_MIN_MAX, .width = 4};
+  if (kind == S21_NORM_1) r.kind = R_ABS_COLUMNS, r.width = A->columns;
+  if (kind == S21_NORM_INF) r.kind = R_ROW_ABS, r.width = 1;
+  int chunks, status = s21_reduce(&r, &chunks);
+  double norm = 0;
+  if (!status && kind == S21_NORM_1) {
+    s21_fold(&r, chunks);
+    for (int j = 0; j < r.width; j++) norm = s21_max_nan(norm, r.part[j]);
+  } else if (!status) {
+    FOR(chunks) {
+      double *p = r.part + (size_t)i * r.width;
+      if (kind == S21_NORM_MAX)
+        norm = s21_max_nan(norm, p[3] ? NAN : p[2]);
+      else
+        norm = s21_max_nan(norm, p[0]);
+    }
+  }
+  free(r.part);
+  if (!status) *result = norm;
+  return status;
+}
+
+int s21_trace(M_ADRES) {
+  S21_STAT(S21_OP_REDUCE, s21_m_valid(A) ? A->rows : 0);
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (!s21_check_square(A)) return ERR_CALC;
+  double sum = 0;
+  FOR(A->rows) sum += A->matrix[i][i];
+  *result = sum;
+  return OK;
+}
+
+int s21_row_sums(matrix_t *A, s21_vector_t *result) {
+  S21_STAT(S21_OP_REDUCE, s21_m_valid(A) ? (double)A->rows * A->columns : 0);
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (s21_create_vector(A->rows, result)) return ERR_FAIL;
+  s21_reduce_t r = {.A = A, .kind = R_ROWS, .out = result->data};
+  int chunks, status = s21_reduce(&r, &chunks);
+  free(r.part);
+  if (status) s21_remove_vector(result);
+  return status;
+}
+
+int s21_column_sums(matrix_t *A, s21_vector_t *result) {
+  S21_STAT(S21_OP_REDUCE, s21_m_valid(A) ? (double)A->rows * A->columns : 0);
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  if (s21_create_vector(A->columns, result)) return ERR_FAIL;
+  s21_reduce_t r = {.A = A, .kind = R_COLUMNS, .width = A->columns};
+  int chunks, status = s21_reduce(&r, &chunks);
+  if (!status) s21_fold(&r, chunks);
+  if (!status) memcpy(result->data, r.part, sizeof(double) * r.width);
+  free(r.part);
+  if (status) s21_remove_vector(result);
+  return status;
+}
+
+// ERR_CALC when every entry is NaN
+int s21_min_max(matrix_t *A, double *min, double *max) {
+  S21_STAT(S21_OP_REDUCE, s21_m_valid(A) ? (double)A->rows * A->columns : 0);
+  if (!s21_m_valid(A) || !min || !max) return ERR_FAIL;
+  s21_reduce_t r = {.A = A, .kind = R_MIN_MAX, .width = 4};
+  int chunks, status = s21_reduce(&r, &chunks);
+  double lo = INFINITY, hi = -INFINITY;
+  if (!status) FOR(chunks) {
+    lo = r.part[i * 4] < lo ? r.part[i * 4] : lo;
+    hi = r.part[i * 4 + 1] > hi ? r.part[i * 4 + 1] : hi;
+  }
+  free(r.part);
+  if (!status && lo > hi) status = ERR_CALC;
+  if (!status) *min = lo, *max = hi;
+  return status;
+}
@@ -0,0 +1,181 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+
+#include "s21_matrix.h"
+
+//================   INSTRUMENTATION   =====================
+
+static const char *s21_op_names[S21_OP_COUNT] = {
+    "create",      "sum",         "sub",      "mult_number",
+    "mult",        "transpose",   "determinant",
+    "complements", "inverse",     "cholesky", "cholesky_solve",
+    "qr",          "lstsq",       "pow",      "exp",
+    "gemv",        "reduce",      "cond",     "eigen",
+    "svd",         "io",          "hadamard", "kron"};
+
+const char *s21_op_name(s21_op_t op) {
+  return op >= 0 && op < S21_OP_COUNT ? s21_op_names[op] : NULL;
+}
+
+#ifdef S21_STATS
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define LOAD(x) atomic_load_explicit(&(x), memory_order_relaxed)
+#define BUMP(x, v) \
+  atomic_store_explicit(&(x), LOAD(x) + (v), memory_order_relaxed)
+#define ULL unsigned long long
+
+typedef struct {
+  atomic_ullong calls, flops, nanos;
+} s21_op_counter_t;
+
+// written only by the owning thread, so a relaxed load + store is enough
+typedef struct s21_thread_stats {
+  s21_op_counter_t ops[S21_OP_COUNT];
+  atomic_ullong bytes_total;
+  int active[S21_OP_COUNT];
+  struct s21_thread_stats *next;
+} s21_thread_stats_t;
+
+static pthread_mutex_t s21_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t s21_once = PTHREAD_ONCE_INIT;
+static pthread_key_t s21_key;
+static s21_thread_stats_t *s21_threads, s21_retired;
+static s21_stats_t s21_baseline;
+static atomic_llong s21_live, s21_peak;
+static _Thread_local s21_thread_stats_t *s21_tls;
+
+static void s21_merge(s21_stats_t *out, s21_thread_stats_t *t) {
+  FOR(S21_OP_COUNT) {
+    out->ops[i].calls += LOAD(t->ops[i].calls);
+    out->ops[i].flops += LOAD(t->ops[i].flops);
+    out->ops[i].nanos += LOAD(t->ops[i].nanos);
+  }
+  out->bytes_total += LOAD(t->bytes_total);
+}
+
+// a finished thread folds its counters into s21_retired
+static void s21_thread_exit(void *arg) {
+  s21_thread_stats_t *t = arg, **p = &s21_threads;
+  pthread_mutex_lock(&s21_lock);
+  while (*p && *p != t) p = &(*p)->next;
+  if (*p) *p = t->next;
+  FOR(S21_OP_COUNT) {
+    BUMP(s21_retired.ops[i].calls, LOAD(t->ops[i].calls));
+    BUMP(s21_retired.ops[i].flops, LOAD(t->ops[i].flops));
+    BUMP(s21_retired.ops[i].nanos, LOAD(t->ops[i].nanos));
+  }
+  BUMP(s21_retired.bytes_total, LOAD(t->bytes_total));
+  pthread_mutex_unlock(&s21_lock);
+  free(t);
+}
+
+static void s21_key_init(void) {
+  pthread_key_create(&s21_key, s21_thread_exit);
+}
+
+static s21_thread_stats_t *s21_thread_stats(void) {
+  if (s21_tls) return s21_tls;
+  pthread_once(&s21_once, s21_key_init);
+  s21_thread_stats_t *t = calloc(1, sizeof(s21_thread_stats_t));
+  if (!t) return NULL;
+  pthread_mutex_lock(&s21_lock);
+  t->next = s21_threads, s21_threads = t;
+  pthread_mutex_unlock(&s21_lock);
+  pthread_setspecific(s21_key, t);
+  return s21_tls = t;
+}
+
+static ULL s21_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ULL)ts.tv_sec * 1000000000ULL + (ULL)ts.tv_nsec;
+}
+
+// nested calls of the same operation (recursion) count once, outermost
+void s21_stat_enter(s21_stat_scope_t *s, s21_op_t op, double flops) {
+  s21_thread_stats_t *t = s21_thread_stats();
+  s->op = op, s->outer = t && !t->active[op]++;
+  if (!s->outer) return;
+  BUMP(t->ops[op].calls, 1);
+  BUMP(t->ops[op].flops, flops < 1.8e19 ? (ULL)flops : ~0ULL);
+  s->start = s21_now();
+}
+
+void s21_stat_leave(s21_stat_scope_t *s) {
+  s21_thread_stats_t *t = s21_tls;
+  if (!t) return;
+  t->active[s->op]--;
+  if (s->outer) BUMP(t->ops[s->op].nanos, s21_now() - s->start);
+}
+
+void s21_stat_bytes(long long bytes) {
+  long long live = atomic_fetch_add(&s21_live, bytes) + bytes;
+  long long peak = atomic_load(&s21_peak);
+  while (live > peak && !atomic_compare_exchange_weak(&s21_peak, &peak, live))
+    ;
+  s21_thread_stats_t *t = s21_thread_stats();
+  if (t && bytes > 0) BUMP(t->bytes_total, bytes);
+}
+
+static void s21_raw_snapshot(s21_stats_t *out) {
+  *out = (s21_stats_t){0};
+  pthread_mutex_lock(&s21_lock);
+  for (s21_thread_stats_t *t = s21_threads; t; t = t->next) s21_merge(out, t);
+  s21_merge(out, &s21_retired);
+  pthread_mutex_unlock(&s21_lock);
+  out->bytes_live = atomic_load(&s21_live);
+  out->bytes_peak = atomic_load(&s21_peak);
+}
+
+// counters are never cleared under a running thread, only rebased
+void s21_stats_snapshot(s21_stats_t *out) {
+  if (!out) return;
+  s21_raw_snapshot(out);
+  pthread_mutex_lock(&s21_lock);
+  FOR(S21_OP_COUNT) {
+    out->ops[i].calls -= s21_baseline.ops[i].calls;
+    out->ops[i].flops -= s21_baseline.ops[i].flops;
+    out->ops[i].nanos -= s21_baseline.ops[i].nanos;
+  }
+  out->bytes_total -= s21_baseline.bytes_total;
+  pthread_mutex_unlock(&s21_lock);
+}
+
+void s21_stats_reset(void) {
+  s21_stats_t now;
+  s21_raw_snapshot(&now);
+  atomic_store(&s21_peak, now.bytes_live);
+  pthread_mutex_lock(&s21_lock);
+  s21_baseline = now;
+  pthread_mutex_unlock(&s21_lock);
+}
+#else
+void s21_stats_snapshot(s21_stats_t *out) {
+  if (out) *out = (s21_stats_t){0};
+}
+void s21_stats_reset(void) {}
+#endif
+
+// snprintf semantics: returns the full length, writes at most size bytes
+int s21_stats_json(char *buf, size_t size) {
+  s21_stats_t st;
+  s21_stats_snapshot(&st);
+  if (!buf) size = 0;
+  int len = 0;
+#define EMIT(...)                                                   \
+  len += snprintf((size_t)len < size ? buf + len : NULL,            \
+                  (size_t)len < size ? size - len : 0, __VA_ARGS__)
+  EMIT("{\"bytes_total\":%llu,\"bytes_live\":%lld,\"bytes_peak\":%lld,",
+       st.bytes_total, st.bytes_live, st.bytes_peak);
+  EMIT("\"ops\":{");
+  FOR(S21_OP_COUNT)
+  EMIT("%s\"%s\":{\"calls\":%llu,\"flops\":%llu,\"nanos\":%llu}",
+       i ? "," : "", s21_op_names[i], st.ops[i].calls, st.ops[i].flops,
+       st.ops[i].nanos);
+  EMIT("}}");
+#undef EMIT
+  return len;
+}
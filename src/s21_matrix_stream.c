@@ -0,0 +1,181 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+
+#include "s21_matrix.h"
+
+//===================   STREAMING   ========================
+
+enum { S21_STREAM_SUM, S21_STREAM_SUB, S21_STREAM_MULT_NUMBER };
+enum { S21_READ_ERR = -1, S21_READ_SHAPE = -2 };
+
+typedef struct {
+  double *a, *b;
+  int count;  // rows held, 0 at the end of input, S21_READ_* on failure
+  int full;
+} s21_chunk_t;
+
+typedef struct {
+  s21_source_t A, B;
+  int columns, chunk_rows, stop;
+  s21_chunk_t ring[S21_STREAM_DEPTH];
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+} s21_stream_t;
+
+// readers may return short counts, keep asking until a chunk is full
+static int s21_read_chunk(s21_source_t src, double *rows, int max, int cols) {
+  int total = 0, n = 1;
+  while (total < max && n > 0) {
+    n = src.read(src.ctx, rows + (size_t)total * cols, max - total, cols);
+    if (n < 0 || n > max - total) return S21_READ_ERR;
+    total += n;
+  }
+  return total;
+}
+
+// reader stage: fills ring slots ahead of the transform stage
+static void *s21_stream_reader(void *arg) {
+  s21_stream_t *s = arg;
+  for (int k = 0, count = 1; count > 0; k = (k + 1) % S21_STREAM_DEPTH) {
+    s21_chunk_t *c = &s->ring[k];
+    pthread_mutex_lock(&s->lock);
+    while (c->full && !s->stop) pthread_cond_wait(&s->cond, &s->lock);
+    int stop = s->stop;
+    pthread_mutex_unlock(&s->lock);
+    if (stop) break;
+
+    count = s21_read_chunk(s->A, c->a, s->chunk_rows, s->columns);
+    if (count >= 0 && c->b) {
+      int count_b = s21_read_chunk(s->B, c->b, s->chunk_rows, s->columns);
+      if (count_b != count) count = count_b < 0 ? S21_READ_ERR : S21_READ_SHAPE;
+    }
+    pthread_mutex_lock(&s->lock);
+    c->count = count, c->full = 1;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+  }
+  return NULL;
+}
+
+// transform stage, in place over the A chunk
+S21_CLONES static int s21_stream_kernel(int op, double *restrict a,
+                                        const double *restrict b,
+                                        double number, size_t n) {
+  int finite = 1;
+  if (op == S21_STREAM_SUM)
+    for (size_t i = 0; i < n; i++) a[i] += b[i];
+  else if (op == S21_STREAM_SUB)
+    for (size_t i = 0; i < n; i++) a[i] -= b[i];
+  else
+    for (size_t i = 0; i < n; i++) finite &= is_fin(a[i]), a[i] *= number;
+  return finite ? OK : ERR_CALC;
+}
+
+static int s21_stream_run(s21_stream_t *s, int op, double number,
+                          s21_sink_t out) {
+  int status = OK;
+  pthread_t reader;
+  if (pthread_create(&reader, NULL, s21_stream_reader, s)) return ERR_FAIL;
+  for (int k = 0; !status; k = (k + 1) % S21_STREAM_DEPTH) {
+    s21_chunk_t *c = &s->ring[k];
+    pthread_mutex_lock(&s->lock);
+    while (!c->full) pthread_cond_wait(&s->cond, &s->lock);
+    pthread_mutex_unlock(&s->lock);
+    if (c->count == S21_READ_ERR) status = ERR_FAIL;
+    if (c->count == S21_READ_SHAPE) status = ERR_CALC;
+    if (c->count <= 0) break;
+    status = s21_stream_kernel(op, c->a, c->b, number,
+                               (size_t)c->count * s->columns);
+    if (!status && out.write(out.ctx, c->a, c->count, s->columns))
+      status = ERR_FAIL;
+    pthread_mutex_lock(&s->lock);
+    c->full = 0;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+  }
+  pthread_mutex_lock(&s->lock);
+  s->stop = 1;
+  pthread_cond_broadcast(&s->cond);
+  pthread_mutex_unlock(&s->lock);
+  pthread_join(reader, NULL);
+  return status;
+}
+
+// memory is S21_STREAM_DEPTH chunks of chunk_rows x columns per input
+static int s21_stream(int op, s21_source_t *A, s21_source_t *B, double number,
+                      int columns, s21_sink_t out, int chunk_rows) {
+  if (!A || !A->read || (op != S21_STREAM_MULT_NUMBER && (!B || !B->read)))
+    return ERR_FAIL;
+  if (!out.write || columns <= 0 || chunk_rows <= 0) return ERR_FAIL;
+  if (op == S21_STREAM_MULT_NUMBER && !is_fin(number)) return ERR_CALC;
+
+  s21_stream_t s = {.A = *A, .columns = columns, .chunk_rows = chunk_rows};
+  if (B) s.B = *B;
+  size_t size = (size_t)chunk_rows * columns;
+  int status = OK;
+  int binary = op != S21_STREAM_MULT_NUMBER;
+  FOR(S21_STREAM_DEPTH) {
+    s.ring[i].a = malloc(sizeof(double) * size);
+    if (binary) s.ring[i].b = malloc(sizeof(double) * size);
+    if (!s.ring[i].a || (binary && !s.ring[i].b)) status = ERR_FAIL;
+  }
+  if (!status) {
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.cond, NULL);
+    status = s21_stream_run(&s, op, number, out);
+    pthread_cond_destroy(&s.cond);
+    pthread_mutex_destroy(&s.lock);
+  }
+  FOR(S21_STREAM_DEPTH) free(s.ring[i].a), free(s.ring[i].b);
+  return status;
+}
+
+int s21_stream_sum(s21_source_t *A, s21_source_t *B, int columns,
+                   s21_sink_t out, int chunk_rows) {
+  return s21_stream(S21_STREAM_SUM, A, B, 0, columns, out, chunk_rows);
+}
+
+int s21_stream_sub(s21_source_t *A, s21_source_t *B, int columns,
+                   s21_sink_t out, int chunk_rows) {
+  return s21_stream(S21_STREAM_SUB, A, B, 0, columns, out, chunk_rows);
+}
+
+int s21_stream_mult_number(s21_source_t *A, double number, int columns,
+                           s21_sink_t out, int chunk_rows) {
+  return s21_stream(S21_STREAM_MULT_NUMBER, A, NULL, number, columns, out,
+                    chunk_rows);
+}
+
+//===============   STOCK SOURCES / SINKS   =================
+
+int s21_matrix_reader(void *ctx, double *rows, int max_rows, int columns) {
+  s21_cursor_t *c = ctx;
+  if (!s21_m_valid(c->m) || c->m->columns != columns) return S21_READ_ERR;
+  int n = 0;
+  for (; n < max_rows && c->row < c->m->rows; n++, c->row++)
+    for (int j = 0; j < columns; j++)
+      rows[(size_t)n * columns + j] = c->m->matrix[c->row][j];
+  return n;
+}
+
+int s21_matrix_writer(void *ctx, const double *rows, int count, int columns) {
+  s21_cursor_t *c = ctx;
+  if (!s21_m_valid(c->m) || c->m->columns != columns) return ERR_FAIL;
+  if (s21_is_frozen(c->m) || s21_detach_matrix(c->m)) return ERR_FAIL;
+  if (c->row + count > c->m->rows) return ERR_CALC;
+  FORS(count, columns) c->m->matrix[c->row + i][j] = rows[i * columns + j];
+  c->row += count;
+  return OK;
+}
+
+// raw native-endian doubles, ctx is a FILE *
+int s21_file_reader(void *ctx, double *rows, int max_rows, int columns) {
+  size_t n = fread(rows, sizeof(double) * columns, max_rows, ctx);
+  return n < (size_t)max_rows && ferror(ctx) ? S21_READ_ERR : (int)n;
+}
+
+int s21_file_writer(void *ctx, const double *rows, int count, int columns) {
+  size_t n = fwrite(rows, sizeof(double) * columns, count, ctx);
+  return n == (size_t)count ? OK : ERR_FAIL;
+}
@@ -0,0 +1,274 @@
+#include <float.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+#define MAX_SWEEPS 60
+#define MT_WORK 65536  // row length x rows below which a round stays serial
+#define OVERSAMPLE 10  // extra random directions of s21_svd_top
+#define POWER_ITERS 2  // subspace iterations of s21_svd_top
+#define SEED 0x2545F4914F6CDD1DULL
+#define LANES 4
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define SWEEP_FLOPS(A) \
+  (10.0 * (A)->rows * (A)->columns * MIN((A)->rows, (A)->columns))
+
+//=======================   SVD   ==========================
+
+S21_CLONES static double s21_dot_lanes(const double *restrict a,
+                                       const double *restrict b, int n) {
+  double acc[LANES] = {0};
+  int j = 0;
+  for (; j + LANES <= n; j += LANES)
+    for (int l = 0; l < LANES; l++) acc[l] += a[j + l] * b[j + l];
+  double s = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for (; j < n; j++) s += a[j] * b[j];
+  return s;
+}
+
+// singular triplets as rows: u[p] (length m), v[p] (length n), s[p]
+// descending, p < k = min(m, n)
+typedef struct {
+  matrix_t u, v;
+  double *s;
+  int k;
+} s21_svd_ws_t;
+
+typedef struct {
+  double **w, **j, tol;
+  int *rotated, len, k, players, round, threads;
+} s21_jacobi_t;
+
+// rows p < q that meet in pair i of a round-robin round; every pair of
+// rows meets once per players - 1 rounds and no row twice in a round
+static void s21_pairing(const s21_jacobi_t *t, int i, int *p, int *q) {
+  int n = t->players - 1;
+  int a = i ? 1 + (i - 1 + t->round) % n : 0;
+  int b = 1 + (n - 1 - i + t->round) % n;
+  *p = MIN(a, b), *q = MAX(a, b);
+}
+
+static void s21_rotate_rows(double *restrict x, double *restrict y, int len,
+                            double c, double s) {
+  for (int j = 0; j < len; j++) {
+    double a = x[j], b = y[j];
+    x[j] = c * a - s * b, y[j] = s * a + c * b;
+  }
+}
+
+// orthogonalizes rows p and q of w, the same rotation goes to j
+S21_CLONES static int s21_jacobi_pair(s21_jacobi_t *t, int p, int q) {
+  double *wp = t->w[p], *wq = t->w[q];
+  double alpha = s21_dot_lanes(wp, wp, t->len);
+  double beta = s21_dot_lanes(wq, wq, t->len);
+  double gamma = s21_dot_lanes(wp, wq, t->len);
+  if (fabs(gamma) <= t->tol * sqrt(alpha) * sqrt(beta)) return 0;
+  double zeta = (beta - alpha) / (2 * gamma);
+  double tn = copysign(1, zeta) / (fabs(zeta) + hypot(1, zeta));
+  double c = 1 / sqrt(1 + tn * tn), s = c * tn;
+  s21_rotate_rows(wp, wq, t->len, c, s);
+  s21_rotate_rows(t->j[p], t->j[q], t->k, c, s);
+  return 1;
+}
+
+static void s21_jacobi_band(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_jacobi_t *t = ctx;
+  int pairs = t->players / 2, p, q;
+  int i0 = (int)((long)pairs * task / t->threads);
+  int i1 = (int)((long)pairs * (task + 1) / t->threads);
+  for (int i = i0; i < i1; i++) {
+    s21_pairing(t, i, &p, &q);
+    t->rotated[i] = q < t->k && s21_jacobi_pair(t, p, q);
+  }
+}
+
+// one-sided Jacobi on the k rows of w until they are orthogonal; pairs
+// of a round are disjoint and split over threads without changing bits.
+// ERR_CALC when the sweeps run out, ERR_FAIL when a round cannot run
+static int s21_jacobi(double **w, double **j, int k, int len, int threads) {
+  s21_jacobi_t t = {.w = w, .j = j, .k = k, .len = len,
+                    .tol = sqrt(len) * DBL_EPSILON,
+                    .players = k + k % 2};
+  t.threads = (long)len * k >= MT_WORK ? threads : 1;
+  t.rotated = calloc(t.players / 2 + 1, sizeof(int));
+  if (!t.rotated) return ERR_FAIL;
+  int status = ERR_CALC;
+  for (int sweep = 0; sweep < MAX_SWEEPS && status == ERR_CALC; sweep++) {
+    int rotated = 0, failed = OK;
+    for (t.round = 0; t.round < t.players - 1 && !failed; t.round++) {
+      if (t.threads > 1)
+        failed = s21_parallel_static(t.threads, s21_jacobi_band, &t);
+      else
+        s21_jacobi_band(&t, 0, 0);
+      FOR(t.players / 2) rotated |= t.rotated[i];
+    }
+    if (failed)
+      status = ERR_FAIL;
+    else if (!rotated)
+      status = OK;
+  }
+  free(t.rotated);
+  return status;
+}
+
+static void s21_svd_free(s21_svd_ws_t *ws) {
+  s21_remove_matrix(&ws->u);
+  s21_remove_matrix(&ws->v);
+  free(ws->s);
+}
+
+// A^T's columns (A's rows when m < n) orthogonalized into U S, the
+// rotations accumulated into V; triplets sorted by descending s
+static int s21_svd_rows(matrix_t *A, s21_svd_ws_t *ws) {
+  int m = A->rows, n = A->columns, k = MIN(m, n), len = MAX(m, n);
+  *ws = (s21_svd_ws_t){.k = k};
+  matrix_t w = {0}, rot = {0};
+  int status = m >= n ? s21_transpose(A, &w) : s21_create_matrix(m, n, &w);
+  if (!status && m < n) FORS(m, n) w.matrix[i][j] = A->matrix[i][j];
+  if (!status) status = s21_create_matrix(k, k, &rot) ? ERR_FAIL : OK;
+  ws->s = malloc(sizeof(double) * k);
+  if (!ws->s) status = ERR_FAIL;
+  s21_plan_t plan;
+  if (!status) status = s21_plan(S21_OP_SVD, A, NULL, &plan);
+  if (!status) FOR(k) rot.matrix[i][i] = 1;
+  if (!status)
+    status = s21_jacobi(w.matrix, rot.matrix, k, len, plan.threads);
+  for (int i = 0; !status && i < k; i++) {
+    double s = sqrt(s21_dot_lanes(w.matrix[i], w.matrix[i], len));
+    for (int c = 0; s > 0 && c < len; c++) w.matrix[i][c] /= s;
+    ws->s[i] = s;
+  }
+  for (int i = 0; !status && i < k; i++) {  // selection sort, rows follow
+    int top = i;
+    for (int c = i + 1; c < k; c++)
+      if (ws->s[c] > ws->s[top]) top = c;
+    double s = ws->s[i], *wr = w.matrix[i], *jr = rot.matrix[i];
+    ws->s[i] = ws->s[top], ws->s[top] = s;
+    w.matrix[i] = w.matrix[top], w.matrix[top] = wr;
+    rot.matrix[i] = rot.matrix[top], rot.matrix[top] = jr;
+  }
+  ws->u = m >= n ? w : rot, ws->v = m >= n ? rot : w;
+  if (status) s21_svd_free(ws);
+  return status;
+}
+
+// row p of rows becomes column p of result, p < count
+static int s21_columns(matrix_t *rows, int count, matrix_t *result) {
+  if (s21_create_matrix(rows->columns, count, result)) return ERR_FAIL;
+  FORS(rows->columns, count) result->matrix[i][j] = rows->matrix[j][i];
+  return OK;
+}
+
+int s21_svd(matrix_t *A, matrix_t *U, s21_vector_t *S, matrix_t *V) {
+  S21_STAT(S21_OP_SVD, s21_m_valid(A) ? SWEEP_FLOPS(A) * 6 : 0);
+  if (!s21_m_valid(A) || !S) return ERR_FAIL;
+  s21_svd_ws_t ws;
+  int status = s21_svd_rows(A, &ws);
+  if (status) return status;
+  if (U) *U = (matrix_t){0};
+  if (V) *V = (matrix_t){0};
+  status = s21_create_vector(ws.k, S);
+  if (!status) memcpy(S->data, ws.s, sizeof(double) * ws.k);
+  if (!status && U) status = s21_columns(&ws.u, ws.k, U);
+  if (!status && V) status = s21_columns(&ws.v, ws.k, V);
+  if (status) {
+    s21_remove_vector(S);
+    if (U) s21_remove_matrix(U);
+    if (V) s21_remove_matrix(V);
+  }
+  s21_svd_free(&ws);
+  return status;
+}
+
+// A+ = sum over s_p > tol of v_p u_p^T / s_p
+int s21_pinv(matrix_t *A, double tol, matrix_t *result) {
+  S21_STAT(S21_OP_SVD, s21_m_valid(A) ? SWEEP_FLOPS(A) * 6 : 0);
+  if (!s21_m_valid(A) || !result) return ERR_FAIL;
+  s21_svd_ws_t ws;
+  int status = s21_svd_rows(A, &ws), m = A->rows, n = A->columns;
+  if (status) return status;
+  if (s21_create_matrix(n, m, result)) return s21_svd_free(&ws), ERR_FAIL;
+  if (tol < 0) tol = MAX(m, n) * DBL_EPSILON * ws.s[0];
+  for (int p = 0; p < ws.k && ws.s[p] > tol; p++) {
+    const double *u = ws.u.matrix[p], *v = ws.v.matrix[p];
+    FOR(n) {
+      double f = v[i] / ws.s[p], *restrict r = result->matrix[i];
+      for (int j = 0; j < m; j++) r[j] += f * u[j];
+    }
+  }
+  s21_svd_free(&ws);
+  return OK;
+}
+
+// xorshift64*, uniform on [-1, 1)
+static double s21_uniform(unsigned long long *state) {
+  *state ^= *state >> 12, *state ^= *state << 25, *state ^= *state >> 27;
+  return (double)((*state * SEED) >> 11) * 0x1p-52 - 1;
+}
+
+static int s21_orth(matrix_t *Y, matrix_t *Q) {
+  matrix_t R = {0};
+  int status = s21_qr(Y, Q, &R);
+  s21_remove_matrix(&R);
+  s21_remove_matrix(Y);
+  return status;
+}
+
+// Q with orthonormal columns spanning A Omega, sharpened by POWER_ITERS
+// rounds of (A A^T); Omega is drawn from a fixed seed
+static int s21_range(matrix_t *A, matrix_t *At, int l, matrix_t *Q) {
+  matrix_t omega = {0}, Y = {0}, Z = {0};
+  unsigned long long state = SEED;
+  int status = s21_create_matrix(A->columns, l, &omega) ? ERR_FAIL : OK;
+  if (!status) FORS(A->columns, l) omega.matrix[i][j] = s21_uniform(&state);
+  if (!status) status = s21_mult_matrix(A, &omega, &Y);
+  s21_remove_matrix(&omega);
+  if (!status) status = s21_orth(&Y, Q);
+  for (int it = 0; it < POWER_ITERS && !status; it++) {
+    status = s21_mult_matrix(At, Q, &Y);
+    s21_remove_matrix(Q);
+    if (!status) status = s21_orth(&Y, &Z);
+    if (!status) status = s21_mult_matrix(A, &Z, &Y);
+    s21_remove_matrix(&Z);
+    if (!status) status = s21_orth(&Y, Q);
+  }
+  return status;
+}
+
+// A ~ Q B with B = Q^T A small: the SVD of B^T = Ub S Vb^T gives
+// U = Q Vb and V = Ub
+int s21_svd_top(matrix_t *A, int k, matrix_t *U, s21_vector_t *S,
+                matrix_t *V) {
+  S21_STAT(S21_OP_SVD, s21_m_valid(A) ? 4.0 * (POWER_ITERS + 1) * A->rows *
+                                            A->columns * (k + OVERSAMPLE)
+                                      : 0);
+  if (!s21_m_valid(A) || !S || k <= 0) return ERR_FAIL;
+  int l = MIN(k + OVERSAMPLE, MIN(A->rows, A->columns));
+  if (k > l) return ERR_CALC;
+  matrix_t At = {0}, Q = {0}, Bt = {0}, Vb = {0};
+  s21_svd_ws_t ws = {0};
+  if (U) *U = (matrix_t){0};
+  if (V) *V = (matrix_t){0};
+  int status = s21_transpose(A, &At);
+  if (!status) status = s21_range(A, &At, l, &Q);
+  if (!status) status = s21_mult_matrix(&At, &Q, &Bt);
+  if (!status) status = s21_svd_rows(&Bt, &ws);
+  if (!status) status = s21_create_vector(k, S);
+  if (!status) memcpy(S->data, ws.s, sizeof(double) * k);
+  if (!status && U) status = s21_columns(&ws.v, k, &Vb);
+  if (!status && U) status = s21_mult_matrix(&Q, &Vb, U);
+  if (!status && V) status = s21_columns(&ws.u, k, V);
+  if (status) {
+    s21_remove_vector(S);
+    if (U) s21_remove_matrix(U);
+    if (V) s21_remove_matrix(V);
+  }
+  s21_remove_matrix(&At);
+  s21_remove_matrix(&Q);
+  s21_remove_matrix(&Bt);
+  s21_remove_matrix(&Vb);
+  s21_svd_free(&ws);
+  return status;
+}
@@ -0,0 +1,134 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "s21_matrix.h"
+
+//====================   TOPOLOGY   ========================
+
+static atomic_int s21_affinity = S21_AFFINITY_NONE;
+
+#ifdef __linux__
+static pthread_once_t s21_topology_once = PTHREAD_ONCE_INIT;
+static cpu_set_t s21_node_cpus[S21_MAX_NODES];
+static int s21_nodes = 1;
+
+// cpulist format: "0-3,8-11"
+static int s21_read_cpulist(int node, cpu_set_t *set) {
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+           node);
+  FILE *f = fopen(path, "r");
+  if (!f) return ERR_FAIL;
+  CPU_ZERO(set);
+  for (int lo, hi, c; fscanf(f, "%d", &lo) == 1;) {
+    hi = lo;
+    if ((c = fgetc(f)) == '-' && fscanf(f, "%d", &hi) == 1) c = fgetc(f);
+    for (int cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, set);
+    if (c != ',') break;
+  }
+  fclose(f);
+  return OK;
+}
+
+static void s21_topology_init(void) {
+  int nodes = 0;
+  while (nodes < S21_MAX_NODES &&
+         !s21_read_cpulist(nodes, &s21_node_cpus[nodes]))
+    nodes++;
+  s21_nodes = nodes > 0 ? nodes : 1;
+}
+
+int s21_numa_nodes(void) {
+  pthread_once(&s21_topology_once, s21_topology_init);
+  return s21_nodes;
+}
+
+// worker tid runs on the CPUs of node tid % nodes, no-op on one node
+static void s21_pin(int tid) {
+  if (atomic_load(&s21_affinity) != S21_AFFINITY_SPREAD) return;
+  if (s21_numa_nodes() < 2) return;
+  cpu_set_t *set = &s21_node_cpus[tid % s21_nodes];
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), set);
+}
+#else
+int s21_numa_nodes(void) { return 1; }
+static void s21_pin(int tid) { (void)tid; }
+#endif
+
+void s21_set_thread_affinity(int mode) { atomic_store(&s21_affinity, mode); }
+
+//===================   THREADING   ========================
+
+typedef struct {
+  atomic_int next;
+  int tasks, is_static;
+  s21_task_fn fn;
+  void *ctx;
+} s21_pool_t;
+
+typedef struct {
+  s21_pool_t *pool;
+  pthread_t thread;
+  int tid;
+} s21_worker_t;
+
+// idle workers keep claiming the next unclaimed task until none remain
+static void *s21_worker(void *arg) {
+  s21_worker_t *w = arg;
+  s21_pin(w->tid);
+  if (w->pool->is_static)
+    w->pool->fn(w->pool->ctx, w->tid, w->tid);
+  else
+    for (int t; (t = atomic_fetch_add(&w->pool->next, 1)) < w->pool->tasks;)
+      w->pool->fn(w->pool->ctx, t, w->tid);
+  return NULL;
+}
+
+int s21_thread_count(int requested, int tasks) {
+  long n = requested > 0 ? requested : sysconf(_SC_NPROCESSORS_ONLN);
+  if (n > tasks) n = tasks;
+  return n > 0 ? (int)n : 1;
+}
+
+static int s21_pool_run(s21_pool_t *pool, int threads) {
+  s21_worker_t *w = calloc(threads, sizeof(s21_worker_t));
+  if (!w) return ERR_FAIL;
+
+  int spawned = 1;
+  FOR(threads) w[i] = (s21_worker_t){.pool = pool, .tid = i};
+  for (int i = 1; i < threads; i++, spawned++)
+    if (pthread_create(&w[i].thread, NULL, s21_worker, &w[i])) break;
+  for (int i = spawned; pool->is_static && i < threads; i++)
+    pool->fn(pool->ctx, i, i);  // bands of threads that failed to start
+
+#ifdef __linux__  // the caller works as tid 0, keep its own affinity
+  cpu_set_t saved;
+  int restore = !pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved);
+  s21_worker(&w[0]);
+  if (restore) pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+#else
+  s21_worker(&w[0]);
+#endif
+  for (int i = 1; i < spawned; i++) pthread_join(w[i].thread, NULL);
+  free(w);
+  return OK;
+}
+
+// runs fn(ctx, task, tid) for every task, tid < s21_thread_count(...)
+int s21_parallel_for(int tasks, int threads, s21_task_fn fn, void *ctx) {
+  if (!fn || tasks < 0) return ERR_FAIL;
+  s21_pool_t pool = {.tasks = tasks, .fn = fn, .ctx = ctx};
+  atomic_init(&pool.next, 0);
+  return s21_pool_run(&pool, s21_thread_count(threads, tasks));
+}
+
+int s21_parallel_static(int threads, s21_task_fn fn, void *ctx) {
+  if (!fn || threads <= 0) return ERR_FAIL;
+  s21_pool_t pool = {.tasks = threads, .is_static = 1, .fn = fn, .ctx = ctx};
+  atomic_init(&pool.next, 0);
+  return s21_pool_run(&pool, threads);
+}
@@ -0,0 +1,87 @@
+#include <string.h>
+
+#include "s21_matrix.h"
+
+#define LANES 4  // independent partial sums, fixed so results repeat
+
+//=====================   VECTORS   ========================
+
+int s21_create_vector(int size, s21_vector_t *result) {
+  if (!result || size <= 0) return ERR_FAIL;
+  size_t bytes = ((size_t)size * sizeof(double) + S21_ALIGN - 1) / S21_ALIGN *
+                 S21_ALIGN;
+  *result = (s21_vector_t){.data = aligned_alloc(S21_ALIGN, bytes),
+                           .size = size};
+  if (!result->data) return ERR_FAIL;
+  memset(result->data, 0, bytes);
+  S21_STAT_BYTES((long long)size * sizeof(double));
+  return OK;
+}
+
+void s21_remove_vector(s21_vector_t *v) {
+  if (!v) return;
+  if (v->data) S21_STAT_BYTES(-(long long)v->size * sizeof(double));
+  free(v->data);
+  v->data = NULL, v->size = 0;
+}
+
+// a . x in LANES interleaved sums, vectorizable without reassociation
+S21_CLONES static double s21_dot(const double *restrict a,
+                                 const double *restrict x, int n) {
+  double acc[LANES] = {0};
+  int j = 0;
+  for (; j + LANES <= n; j += LANES)
+    for (int l = 0; l < LANES; l++) acc[l] += a[j + l] * x[j + l];
+  double s = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for (; j < n; j++) s += a[j] * x[j];
+  return s;
+}
+
+typedef struct {
+  matrix_t *A;
+  const double *x;
+  double *y, alpha, beta;
+  int trans, threads;
+} s21_gemv_t;
+
+static double s21_scaled(double beta, double y) { return beta ? beta * y : 0; }
+
+// one band per thread: rows of y = A x, columns of y = A^T x; no two
+// threads share an output, so the summation order never changes
+S21_CLONES static void s21_gemv_band(void *ctx, int task, int tid) {
+  (void)tid;
+  s21_gemv_t *g = ctx;
+  int m = g->A->rows, n = g->A->columns, len = g->trans ? n : m;
+  int lo = (int)((long)len * task / g->threads);
+  int hi = (int)((long)len * (task + 1) / g->threads);
+  double **a = g->A->matrix, *restrict y = g->y;
+  if (!g->trans) {
+    for (int i = lo; i < hi; i++)
+      y[i] = g->alpha * s21_dot(a[i], g->x, n) + s21_scaled(g->beta, y[i]);
+    return;
+  }
+  for (int j = lo; j < hi; j++) y[j] = s21_scaled(g->beta, y[j]);
+  FOR(m) {
+    const double ax = g->alpha * g->x[i], *restrict ai = a[i];
+    for (int j = lo; j < hi; j++) y[j] += ax * ai[j];
+  }
+}
+
+int s21_gemv(int trans, double alpha, matrix_t *A, s21_vector_t *x,
+             double beta, s21_vector_t *y) {
+  S21_STAT(S21_OP_GEMV, s21_m_valid(A) ? 2.0 * A->rows * A->columns : 0);
+  if (!s21_m_valid(A) || !x || !x->data || !y || !y->data) return ERR_FAIL;
+  if (trans != S21_NO_TRANS && trans != S21_TRANS) return ERR_FAIL;
+  int in = trans ? A->rows : A->columns, out = trans ? A->columns : A->rows;
+  if (x->size != in || y->size != out) return ERR_CALC;
+  if (x->data == y->data) return ERR_CALC;
+
+  s21_plan_t plan;
+  s21_plan(S21_OP_GEMV, A, NULL, &plan);
+  s21_gemv_t g = {.A = A, .x = x->data, .y = y->data, .alpha = alpha,
+                  .beta = beta, .trans = trans, .threads = plan.threads};
+  if (plan.threads > 1)
+    return s21_parallel_static(plan.threads, s21_gemv_band, &g);
+  s21_gemv_band(&g, 0, 0);
+  return OK;
+}
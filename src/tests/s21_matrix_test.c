@@ -5,7 +5,9 @@
 
 #include <check.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -21,6 +23,30 @@ Suite *suite_mult_number_matrix(void);
 Suite *suite_calc_complements(void);
 Suite *suite_determinant(void);
 Suite *suite_inverse_matrix(void);
+Suite *suite_cholesky(void);
+Suite *suite_qr(void);
+Suite *suite_cofactors_mt(void);
+Suite *suite_stats(void);
+Suite *suite_stream(void);
+Suite *suite_async(void);
+Suite *suite_create_matrix_ex(void);
+Suite *suite_create_matrix_aligned(void);
+Suite *suite_matrix_view(void);
+Suite *suite_wrap_matrix(void);
+Suite *suite_cancel(void);
+Suite *suite_plan(void);
+Suite *suite_autotune(void);
+Suite *suite_accumulate(void);
+Suite *suite_matrix_pow(void);
+Suite *suite_band(void);
+Suite *suite_gemv(void);
+Suite *suite_reduce(void);
+Suite *suite_eigen(void);
+Suite *suite_svd(void);
+Suite *suite_io(void);
+Suite *suite_frozen(void);
+Suite *suite_share(void);
+Suite *suite_product(void);
 
 void run_testcase(Suite *testcase);
 double get_rand(double min, double max);
@@ -1222,6 +1248,2683 @@ Suite *suite_inverse_matrix(void) {
 
   return suite;
 }
+void s21_fill_spd(matrix_t *A) {
+  // A = M * M^T + n * I is symmetric positive-definite
+  matrix_t M = {0};
+  s21_create_matrix(A->rows, A->columns, &M);
+  FORS(M.rows, M.columns) M.matrix[i][j] = get_rand(-1, 1);
+  FORS(A->rows, A->columns) {
+    A->matrix[i][j] = (i == j) * A->rows;
+    for (int k = 0; k < A->rows; k++)
+      A->matrix[i][j] += M.matrix[i][k] * M.matrix[j][k];
+  }
+  s21_remove_matrix(&M);
+}
+
+START_TEST(s21_cholesky_1) {
+  // failure with ERR_FAIL and non-square matrix
+  matrix_t A = {0};
+  s21_band_t L = {0};
+  ck_assert_int_eq(s21_cholesky(&A, &L), ERR_FAIL);
+  ck_assert_int_eq(s21_cholesky_solve(&L, &A, &A), ERR_FAIL);
+  s21_create_matrix(3, 2, &A);
+  ck_assert_int_eq(s21_cholesky(&A, &L), ERR_CALC);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_cholesky_2) {
+  // failure with symmetric indefinite matrix
+  matrix_t A = {0};
+  s21_band_t L = {0};
+  s21_create_matrix(2, 2, &A);
+  A.matrix[0][0] = 1, A.matrix[0][1] = 2;
+  A.matrix[1][0] = 2, A.matrix[1][1] = 1;
+  ck_assert_int_eq(s21_cholesky(&A, &L), ERR_CALC);
+  ck_assert_ptr_null(L.row);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_cholesky_3) {
+  // success with reference values, L holds n (n + 1) / 2 entries
+  matrix_t A = {0};
+  s21_band_t L = {0};
+  matrix_t full = {0};
+  matrix_t eq_matrix = {0};
+  s21_create_matrix(3, 3, &A);
+  s21_create_matrix(3, 3, &eq_matrix);
+  A.matrix[0][0] = 4, A.matrix[0][1] = 12, A.matrix[0][2] = -16;
+  A.matrix[1][0] = 12, A.matrix[1][1] = 37, A.matrix[1][2] = -43;
+  A.matrix[2][0] = -16, A.matrix[2][1] = -43, A.matrix[2][2] = 98;
+  eq_matrix.matrix[0][0] = 2;
+  eq_matrix.matrix[1][0] = 6, eq_matrix.matrix[1][1] = 1;
+  eq_matrix.matrix[2][0] = -8, eq_matrix.matrix[2][1] = 5,
+  eq_matrix.matrix[2][2] = 3;
+  ck_assert_int_eq(s21_cholesky(&A, &L), OK);
+  ck_assert_ptr_null(s21_band_at(&L, 0, 1));
+  ck_assert_ptr_eq(L.row[2] + 2, L.data + 5);
+  ck_assert_int_eq(s21_band_to_matrix(&L, &full), OK);
+  ck_assert_int_eq(s21_eq_matrix(&full, &eq_matrix), SUCCESS);
+  double logdet = 0;
+  ck_assert_int_eq(s21_spd_logdet(&A, &logdet), OK);
+  ck_assert_double_eq_tol(logdet, log(36), 1e-12);
+  s21_remove_matrix(&A);
+  s21_remove_band(&L);
+  s21_remove_matrix(&full);
+  s21_remove_matrix(&eq_matrix);
+}
+END_TEST
+
+START_TEST(s21_cholesky_4) {
+  // failure when only the lower triangle is SPD
+  matrix_t A = {0};
+  matrix_t inv = {0};
+  s21_band_t L = {0};
+  double logdet = 0;
+  s21_create_matrix(3, 3, &A);
+  FOR(3) A.matrix[i][i] = 2;
+  A.matrix[1][0] = 1, A.matrix[0][1] = 5;
+  ck_assert_int_eq(s21_cholesky(&A, &L), ERR_CALC);
+  ck_assert_ptr_null(L.row);
+  ck_assert_int_eq(s21_spd_inverse(&A, &inv), ERR_CALC);
+  ck_assert_int_eq(s21_spd_logdet(&A, &logdet), ERR_CALC);
+  A.matrix[0][1] = 1 + 4e-16;  // a rounding error away
+  ck_assert_int_eq(s21_cholesky(&A, &L), OK);
+  s21_remove_matrix(&A);
+  s21_remove_band(&L);
+}
+END_TEST
+
+START_TEST(s21_spd_inverse_1) {
+  // success against the general inverse on random SPD input
+  const int n = rand() % 5 + 2;
+  matrix_t A = {0};
+  matrix_t spd = {0};
+  matrix_t ref = {0};
+  s21_create_matrix(n, n, &A);
+  s21_fill_spd(&A);
+  ck_assert_int_eq(s21_spd_inverse(&A, &spd), OK);
+  ck_assert_int_eq(s21_inverse_matrix(&A, &ref), OK);
+  ck_assert_int_eq(s21_eq_matrix(&spd, &ref), SUCCESS);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&spd);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+START_TEST(s21_cholesky_solve_1) {
+  // success: A * X reproduces B
+  const int n = rand() % 20 + 1;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  s21_band_t L = {0};
+  matrix_t X = {0};
+  matrix_t AX = {0};
+  s21_create_matrix(n, n, &A);
+  s21_create_matrix(n, 3, &B);
+  s21_fill_spd(&A);
+  s21_initialize_matrix(&B, -1, 0.5);
+  ck_assert_int_eq(s21_cholesky(&A, &L), OK);
+  ck_assert_int_eq(s21_cholesky_solve(&L, &B, &X), OK);
+  ck_assert_int_eq(L.kl, n - 1);
+  ck_assert_int_eq(L.ku, 0);
+  ck_assert_int_eq(s21_mult_matrix(&A, &X, &AX), OK);
+  ck_assert_int_eq(s21_eq_matrix(&AX, &B), SUCCESS);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_band(&L);
+  s21_remove_matrix(&X);
+  s21_remove_matrix(&AX);
+}
+END_TEST
+
+Suite *suite_cholesky(void) {
+  Suite *suite = suite_create("s21_cholesky");
+  TCase *tc_core = tcase_create("core_of_cholesky");
+  tcase_add_test(tc_core, s21_cholesky_1);
+  tcase_add_test(tc_core, s21_cholesky_2);
+  tcase_add_test(tc_core, s21_cholesky_3);
+  tcase_add_test(tc_core, s21_cholesky_4);
+  tcase_add_loop_test(tc_core, s21_spd_inverse_1, 0, 20);
+  tcase_add_loop_test(tc_core, s21_cholesky_solve_1, 0, 20);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_qr_1) {
+  // failure with ERR_FAIL and wide matrix
+  matrix_t A = {0};
+  matrix_t Q = {0};
+  matrix_t R = {0};
+  ck_assert_int_eq(s21_qr(&A, &Q, &R), ERR_FAIL);
+  s21_create_matrix(2, 3, &A);
+  ck_assert_int_eq(s21_qr(&A, &Q, &R), ERR_CALC);
+  ck_assert_int_eq(s21_qr(&A, NULL, &R), ERR_FAIL);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_qr_2) {
+  // success: Q * R == A, Q^T * Q == I, R upper triangular
+  const int cols = rand() % 70 + 1;
+  const int rows = cols + rand() % 10;
+  matrix_t A = {0};
+  matrix_t Q = {0};
+  matrix_t R = {0};
+  matrix_t QR = {0};
+  matrix_t QT = {0};
+  matrix_t QTQ = {0};
+  matrix_t I = {0};
+  s21_create_matrix(rows, cols, &A);
+  s21_create_matrix(cols, cols, &I);
+  FORS(rows, cols) A.matrix[i][j] = get_rand(-10, 10);
+  FOR(cols) I.matrix[i][i] = 1;
+  ck_assert_int_eq(s21_qr(&A, &Q, &R), OK);
+  s21_mult_matrix(&Q, &R, &QR);
+  s21_transpose(&Q, &QT);
+  s21_mult_matrix(&QT, &Q, &QTQ);
+  ck_assert_int_eq(s21_eq_matrix(&QR, &A), SUCCESS);
+  ck_assert_int_eq(s21_eq_matrix(&QTQ, &I), SUCCESS);
+  FOR(cols) for (int j = 0; j < i; j++) ck_assert_double_eq(R.matrix[i][j], 0);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&Q);
+  s21_remove_matrix(&R);
+  s21_remove_matrix(&QR);
+  s21_remove_matrix(&QT);
+  s21_remove_matrix(&QTQ);
+  s21_remove_matrix(&I);
+}
+END_TEST
+
+START_TEST(s21_lstsq_1) {
+  // success with line fit y = 2x + 1 through exact points
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t X = {0};
+  s21_create_matrix(5, 2, &A);
+  s21_create_matrix(5, 1, &B);
+  FOR(5) A.matrix[i][0] = i, A.matrix[i][1] = 1, B.matrix[i][0] = 2 * i + 1;
+  ck_assert_int_eq(s21_lstsq(&A, &B, &X), OK);
+  ck_assert_int_eq(X.rows, 2);
+  ck_assert_double_eq_tol(X.matrix[0][0], 2, 1e-12);
+  ck_assert_double_eq_tol(X.matrix[1][0], 1, 1e-12);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&X);
+}
+END_TEST
+
+START_TEST(s21_lstsq_2) {
+  // success: residual is orthogonal to the columns of A
+  const int cols = rand() % 40 + 1;
+  const int rows = cols + rand() % 30;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t X = {0};
+  matrix_t AX = {0};
+  matrix_t res = {0};
+  matrix_t AT = {0};
+  matrix_t ATres = {0};
+  matrix_t zero = {0};
+  s21_create_matrix(rows, cols, &A);
+  s21_create_matrix(rows, 2, &B);
+  s21_create_matrix(cols, 2, &zero);
+  FORS(rows, cols) A.matrix[i][j] = get_rand(-1, 1);
+  FORS(rows, 2) B.matrix[i][j] = get_rand(-1, 1);
+  ck_assert_int_eq(s21_lstsq(&A, &B, &X), OK);
+  s21_mult_matrix(&A, &X, &AX);
+  s21_sub_matrix(&B, &AX, &res);
+  s21_transpose(&A, &AT);
+  s21_mult_matrix(&AT, &res, &ATres);
+  ck_assert_int_eq(s21_eq_matrix(&ATres, &zero), SUCCESS);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&X);
+  s21_remove_matrix(&AX);
+  s21_remove_matrix(&res);
+  s21_remove_matrix(&AT);
+  s21_remove_matrix(&ATres);
+  s21_remove_matrix(&zero);
+}
+END_TEST
+
+START_TEST(s21_lstsq_3) {
+  // failure with rank-deficient matrix and mismatched right-hand side
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t X = {0};
+  s21_create_matrix(3, 2, &A);
+  s21_create_matrix(3, 1, &B);
+  FOR(3) A.matrix[i][0] = 1;
+  ck_assert_int_eq(s21_lstsq(&A, &B, &X), ERR_CALC);
+  s21_remove_matrix(&B);
+  s21_create_matrix(4, 1, &B);
+  ck_assert_int_eq(s21_lstsq(&A, &B, &X), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+}
+END_TEST
+
+// exact equality, element by element
+static void s21_assert_same(matrix_t *X, matrix_t *Y) {
+  ck_assert_int_eq(X->rows, Y->rows);
+  ck_assert_int_eq(X->columns, Y->columns);
+  FORS(X->rows, X->columns) ck_assert(X->matrix[i][j] == Y->matrix[i][j]);
+}
+
+START_TEST(s21_qr_3) {
+  // the planner's threads split columns (QR) and rows (element-wise)
+  // without changing a bit
+  const int n = rand() % 80 + 3, m = n + rand() % 20;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t r[2][6] = {0};
+  s21_create_matrix(m, n, &A);
+  s21_create_matrix(m, 3, &B);
+  FORS(m, n) A.matrix[i][j] = get_rand(-1, 1);
+  FORS(m, 3) B.matrix[i][j] = get_rand(-1, 1);
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  for (int pass = 0; pass < 2; pass++) {
+    t.threads = pass ? 3 : 1, t.threaded_flops = 1;
+    s21_tuning_set(&t);
+    s21_plan_t plan;
+    s21_plan(S21_OP_QR, &A, NULL, &plan);
+    ck_assert_int_eq(plan.threads, pass ? 3 : 1);
+    s21_plan(S21_OP_SUM, &A, &A, &plan);
+    ck_assert_int_eq(plan.algo, pass ? S21_ALGO_THREADED : S21_ALGO_BLOCKED);
+    ck_assert_int_eq(s21_qr(&A, &r[pass][0], &r[pass][1]), OK);
+    ck_assert_int_eq(s21_lstsq(&A, &B, &r[pass][2]), OK);
+    ck_assert_int_eq(s21_sum_matrix(&A, &A, &r[pass][3]), OK);
+    ck_assert_int_eq(s21_sub_matrix(&A, &r[pass][3], &r[pass][4]), OK);
+    ck_assert_int_eq(s21_mult_number(&A, -0.5, &r[pass][5]), OK);
+  }
+  FOR(6) s21_assert_same(&r[0][i], &r[1][i]);
+  FORS(m, n) ck_assert(r[0][4].matrix[i][j] == -A.matrix[i][j]);
+  FOR(12) s21_remove_matrix(&r[i / 6][i % 6]);
+  s21_tuning_set(NULL);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+}
+END_TEST
+
+Suite *suite_qr(void) {
+  Suite *suite = suite_create("s21_qr");
+  TCase *tc_core = tcase_create("core_of_qr");
+  tcase_add_test(tc_core, s21_qr_1);
+  tcase_add_loop_test(tc_core, s21_qr_2, 0, 20);
+  tcase_add_test(tc_core, s21_lstsq_1);
+  tcase_add_loop_test(tc_core, s21_lstsq_2, 0, 20);
+  tcase_add_test(tc_core, s21_lstsq_3);
+  tcase_add_loop_test(tc_core, s21_qr_3, 0, 10);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_cofactors_mt_1) {
+  // failure with ERR_FAIL, non-square and 1x1 matrices
+  matrix_t A = {0};
+  matrix_t result = {0};
+  double det = 0;
+  ck_assert_int_eq(s21_calc_complements_mt(&A, &result, 2, NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_determinant_mt(&A, &det, 2, NULL), ERR_FAIL);
+  s21_create_matrix(2, 3, &A);
+  ck_assert_int_eq(s21_calc_complements_mt(&A, &result, 2, NULL), ERR_CALC);
+  ck_assert_int_eq(s21_determinant_mt(&A, &det, 2, NULL), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_create_matrix(1, 1, &A);
+  ck_assert_int_eq(s21_calc_complements_mt(&A, &result, 2, NULL), ERR_FAIL);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_cofactors_mt_2) {
+  // success: bit-identical to the serial cofactor expansion
+  const int n = _i % 8 + 2;
+  matrix_t A = {0};
+  matrix_t serial = {0};
+  matrix_t parallel = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = get_rand(-10, 10);
+  double det = 0, det_mt = 0;
+  ck_assert_int_eq(s21_determinant(&A, &det), OK);
+  ck_assert_int_eq(s21_determinant_mt(&A, &det_mt, _i % 4, NULL), OK);
+  ck_assert_double_eq(det, det_mt);
+  ck_assert_int_eq(s21_calc_complements(&A, &serial), OK);
+  ck_assert_int_eq(s21_calc_complements_mt(&A, &parallel, _i % 4, NULL), OK);
+  FORS(n, n) ck_assert_double_eq(serial.matrix[i][j], parallel.matrix[i][j]);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&serial);
+  s21_remove_matrix(&parallel);
+}
+END_TEST
+
+Suite *suite_cofactors_mt(void) {
+  Suite *suite = suite_create("s21_cofactors_mt");
+  TCase *tc_core = tcase_create("core_of_cofactors_mt");
+  tcase_add_test(tc_core, s21_cofactors_mt_1);
+  tcase_add_loop_test(tc_core, s21_cofactors_mt_2, 0, 16);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_stats_1) {
+  // counters follow calls, bytes and flops when compiled in
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  s21_stats_t st = {0};
+  s21_stats_reset();
+  s21_create_matrix(2, 3, &A);
+  s21_create_matrix(3, 4, &B);
+  s21_mult_matrix(&A, &B, &C);
+  s21_stats_snapshot(&st);
+#ifdef S21_STATS
+  ck_assert_int_eq(st.ops[S21_OP_CREATE].calls, 3);
+  ck_assert_int_eq(st.ops[S21_OP_MULT].calls, 1);
+  ck_assert_int_eq(st.ops[S21_OP_MULT].flops, 48);
+  // row pointers plus rows: 2x3, 3x4 and 2x4 doubles
+  ck_assert_int_eq(st.bytes_total, 2 * 32 + 3 * 40 + 2 * 40);
+#else
+  ck_assert_int_eq(st.ops[S21_OP_MULT].calls, 0);
+#endif
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+  s21_stats_snapshot(&st);
+  ck_assert_int_eq(st.bytes_live, 0);
+}
+END_TEST
+
+START_TEST(s21_stats_2) {
+  // recursion counts once, reset rebases the counters
+  matrix_t A = {0};
+  double det = 0;
+  s21_stats_t st = {0};
+  s21_create_matrix(4, 4, &A);
+  s21_initialize_matrix(&A, 1, 1);
+  s21_stats_reset();
+  s21_determinant(&A, &det);
+  s21_stats_snapshot(&st);
+#ifdef S21_STATS
+  ck_assert_int_eq(st.ops[S21_OP_DETERMINANT].calls, 1);
+  ck_assert_int_eq(st.ops[S21_OP_CREATE].calls, 4 + 4 * 3);  // minors
+#endif
+  s21_stats_reset();
+  s21_stats_snapshot(&st);
+  ck_assert_int_eq(st.ops[S21_OP_DETERMINANT].calls, 0);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_stats_json_1) {
+  // JSON dump follows snprintf semantics
+  char buf[4096] = {0};
+  char small[8] = {0};
+  int len = s21_stats_json(buf, sizeof(buf));
+  ck_assert_int_gt(len, 0);
+  ck_assert_int_eq(len, (int)strlen(buf));
+  ck_assert_int_eq(s21_stats_json(small, sizeof(small)), len);
+  ck_assert_int_eq(s21_stats_json(NULL, 0), len);
+  ck_assert_int_eq(small[7], 0);
+  ck_assert_int_eq(buf[0], '{');
+  ck_assert_ptr_nonnull(strstr(buf, "\"determinant\":{\"calls\":"));
+  ck_assert_str_eq(s21_op_name(S21_OP_LSTSQ), "lstsq");
+  ck_assert_ptr_null(s21_op_name(S21_OP_COUNT));
+}
+END_TEST
+
+Suite *suite_stats(void) {
+  Suite *suite = suite_create("s21_stats");
+  TCase *tc_core = tcase_create("core_of_stats");
+  tcase_add_test(tc_core, s21_stats_1);
+  tcase_add_test(tc_core, s21_stats_2);
+  tcase_add_test(tc_core, s21_stats_json_1);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_stream_1) {
+  // success: streamed sum/sub/mult_number match the in-memory results
+  const int rows = rand() % 500 + 1;
+  const int cols = rand() % 10 + 1;
+  const int chunk = _i % 7 + 1;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t out = {0};
+  matrix_t ref = {0};
+  s21_create_matrix(rows, cols, &A);
+  s21_create_matrix(rows, cols, &B);
+  s21_create_matrix(rows, cols, &out);
+  FORS(rows, cols) A.matrix[i][j] = get_rand(-1e3, 1e3);
+  FORS(rows, cols) B.matrix[i][j] = get_rand(-1e3, 1e3);
+  for (int op = 0; op < 3; op++) {
+    s21_cursor_t ca = {&A, 0}, cb = {&B, 0}, co = {&out, 0};
+    s21_source_t sa = {s21_matrix_reader, &ca}, sb = {s21_matrix_reader, &cb};
+    s21_sink_t sink = {s21_matrix_writer, &co};
+    if (op == 0) {
+      ck_assert_int_eq(s21_stream_sum(&sa, &sb, cols, sink, chunk), OK);
+      s21_sum_matrix(&A, &B, &ref);
+    } else if (op == 1) {
+      ck_assert_int_eq(s21_stream_sub(&sa, &sb, cols, sink, chunk), OK);
+      s21_sub_matrix(&A, &B, &ref);
+    } else {
+      ck_assert_int_eq(s21_stream_mult_number(&sa, 2.5, cols, sink, chunk),
+                       OK);
+      s21_mult_number(&A, 2.5, &ref);
+    }
+    ck_assert_int_eq(co.row, rows);
+    ck_assert_int_eq(s21_eq_matrix(&out, &ref), SUCCESS);
+    s21_remove_matrix(&ref);
+  }
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&out);
+}
+END_TEST
+
+START_TEST(s21_stream_2) {
+  // failure with bad arguments, mismatched inputs and non-finite values
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t out = {0};
+  s21_create_matrix(5, 2, &A);
+  s21_create_matrix(4, 2, &B);
+  s21_create_matrix(5, 2, &out);
+  s21_cursor_t ca = {&A, 0}, cb = {&B, 0}, co = {&out, 0};
+  s21_source_t sa = {s21_matrix_reader, &ca}, sb = {s21_matrix_reader, &cb};
+  s21_sink_t sink = {s21_matrix_writer, &co};
+  ck_assert_int_eq(s21_stream_sum(&sa, NULL, 2, sink, 3), ERR_FAIL);
+  ck_assert_int_eq(s21_stream_sum(&sa, &sb, 2, sink, 0), ERR_FAIL);
+  ck_assert_int_eq(s21_stream_sum(&sa, &sb, 3, sink, 2), ERR_FAIL);
+  ca.row = 0, co.row = 0;
+  ck_assert_int_eq(s21_stream_sub(&sa, &sb, 2, sink, 3), ERR_CALC);
+  ca.row = 0, co.row = 0;
+  ck_assert_int_eq(s21_stream_mult_number(&sa, NAN, 2, sink, 3), ERR_CALC);
+  A.matrix[4][1] = INFINITY;
+  ck_assert_int_eq(s21_stream_mult_number(&sa, 2, 2, sink, 3), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&out);
+}
+END_TEST
+
+START_TEST(s21_stream_3) {
+  // success: file source to file sink through a bounded chunk
+  FILE *in = tmpfile();
+  FILE *out = tmpfile();
+  for (int i = 0; i < 1000; i++) {
+    double row[3] = {i, -i, 0.5 * i};
+    fwrite(row, sizeof(row), 1, in);
+  }
+  rewind(in);
+  s21_source_t src = {s21_file_reader, in};
+  s21_sink_t sink = {s21_file_writer, out};
+  ck_assert_int_eq(s21_stream_mult_number(&src, -2, 3, sink, 64), OK);
+  rewind(out);
+  double row[3];
+  int count = 0;
+  for (; fread(row, sizeof(row), 1, out) == 1; count++) {
+    ck_assert_double_eq(row[0], -2.0 * count);
+    ck_assert_double_eq(row[2], -1.0 * count);
+  }
+  ck_assert_int_eq(count, 1000);
+  fclose(in);
+  fclose(out);
+}
+END_TEST
+
+Suite *suite_stream(void) {
+  Suite *suite = suite_create("s21_stream");
+  TCase *tc_core = tcase_create("core_of_stream");
+  tcase_add_loop_test(tc_core, s21_stream_1, 0, 20);
+  tcase_add_test(tc_core, s21_stream_2);
+  tcase_add_test(tc_core, s21_stream_3);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+void s21_count_callback(int status, void *arg) {
+  if (status == OK) __atomic_add_fetch((int *)arg, 1, __ATOMIC_SEQ_CST);
+}
+
+START_TEST(s21_async_1) {
+  // success: many mixed jobs complete with the synchronous results
+  enum { JOBS = 32 };
+  matrix_t A[JOBS], B[JOBS], result[JOBS], ref[JOBS];
+  s21_future_t *f[JOBS];
+  int callbacks = 0;
+  for (int k = 0; k < JOBS; k++) {
+    int n = rand() % 40 + 2;
+    A[k] = B[k] = result[k] = ref[k] = (matrix_t){0};
+    s21_create_matrix(n, n, &A[k]);
+    s21_create_matrix(n, 3, &B[k]);
+    FORS(n, n) A[k].matrix[i][j] = get_rand(-5, 5);
+    FORS(n, 3) B[k].matrix[i][j] = get_rand(-5, 5);
+  }
+  FOR(JOBS) {
+    f[i] = s21_async_mult_matrix(&A[i], &B[i], &result[i]);
+    ck_assert_ptr_nonnull(f[i]);
+    ck_assert_int_eq(s21_future_then(f[i], s21_count_callback, &callbacks),
+                     OK);
+  }
+  FOR(JOBS) {
+    ck_assert_int_eq(s21_future_wait(f[i]), OK);
+    ck_assert_int_eq(s21_future_poll(f[i]), 1);
+    s21_mult_matrix(&A[i], &B[i], &ref[i]);
+    ck_assert_int_eq(s21_eq_matrix(&result[i], &ref[i]), SUCCESS);
+    s21_future_free(f[i]);
+  }
+  s21_async_shutdown();
+  ck_assert_int_eq(callbacks, JOBS);
+  FOR(JOBS) {
+    s21_remove_matrix(&A[i]);
+    s21_remove_matrix(&B[i]);
+    s21_remove_matrix(&result[i]);
+    s21_remove_matrix(&ref[i]);
+  }
+}
+END_TEST
+
+START_TEST(s21_async_2) {
+  // inverse job, failing job status and callback on a finished future
+  matrix_t A = {0};
+  matrix_t result = {0};
+  matrix_t bad = {0};
+  matrix_t bad_result = {0};
+  int callbacks = 0;
+  s21_create_matrix(3, 3, &A);
+  A.matrix[0][0] = 2, A.matrix[0][1] = 5, A.matrix[0][2] = 7;
+  A.matrix[1][0] = 6, A.matrix[1][1] = 3, A.matrix[1][2] = 4;
+  A.matrix[2][0] = 5, A.matrix[2][1] = -2, A.matrix[2][2] = -3;
+  s21_future_t *f = s21_async_inverse_matrix(&A, &result);
+  s21_future_t *g = s21_async_inverse_matrix(&bad, &bad_result);
+  ck_assert_int_eq(s21_future_wait(f), OK);
+  ck_assert_double_eq_tol(result.matrix[1][0], -38, 1e-9);
+  ck_assert_int_eq(s21_future_then(f, s21_count_callback, &callbacks), OK);
+  ck_assert_int_eq(callbacks, 1);
+  ck_assert_int_eq(s21_future_then(f, NULL, NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_future_wait(g), ERR_FAIL);
+  ck_assert_int_eq(s21_future_poll(NULL), -1);
+  s21_future_free(f);
+  s21_future_free(g);
+  s21_async_shutdown();
+  s21_async_shutdown();
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&result);
+}
+END_TEST
+
+Suite *suite_async(void) {
+  Suite *suite = suite_create("s21_async");
+  TCase *tc_core = tcase_create("core_of_async");
+  tcase_add_loop_test(tc_core, s21_async_1, 0, 5);
+  tcase_add_test(tc_core, s21_async_2);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_create_matrix_ex_1) {
+  // success: contiguous and first-touch layouts are zeroed and usable
+  const int rows = rand() % 300 + 1;
+  const int cols = rand() % 50 + 1;
+  const int flags = _i % 2 ? S21_ALLOC_FIRST_TOUCH : S21_ALLOC_CONTIGUOUS;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  s21_set_thread_affinity(_i % 4 < 2 ? S21_AFFINITY_NONE
+                                      : S21_AFFINITY_SPREAD);
+  ck_assert_int_eq(s21_create_matrix_ex(rows, cols, flags, &A), OK);
+  ck_assert_int_eq(s21_create_matrix(rows, cols, &B), OK);
+  ck_assert_int_eq(A.flags, flags);
+  ck_assert_ptr_nonnull(A.block);
+  ck_assert_int_eq(s21_eq_matrix(&A, &B), SUCCESS);
+  FORS(rows, cols) A.matrix[i][j] = i - j, B.matrix[i][j] = i - j;
+  ck_assert_ptr_eq(A.matrix[rows - 1], A.block + (rows - 1) * cols);
+  ck_assert_int_eq(s21_sum_matrix(&A, &B, &C), OK);
+  ck_assert_double_eq(C.matrix[rows - 1][0], 2 * (rows - 1));
+  s21_set_thread_affinity(S21_AFFINITY_NONE);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+  ck_assert_ptr_null(A.block);
+}
+END_TEST
+
+START_TEST(s21_create_matrix_ex_2) {
+  // failure with bad dimensions or state bits, default flags fall back to
+  // rows of calloc
+  matrix_t A = {0};
+  ck_assert_int_eq(s21_create_matrix_ex(0, 3, S21_ALLOC_FIRST_TOUCH, &A),
+                   ERR_FAIL);
+  ck_assert_int_eq(s21_create_matrix_ex(3, -1, S21_ALLOC_CONTIGUOUS, &A),
+                   ERR_FAIL);
+  ck_assert_int_eq(s21_create_matrix_ex(3, 3, S21_M_VIEW, &A), ERR_FAIL);
+  ck_assert_int_eq(
+      s21_create_matrix_ex(3, 3, S21_ALLOC_CONTIGUOUS | S21_M_FROZEN, &A),
+      ERR_FAIL);
+  ck_assert_ptr_null(A.matrix);
+  ck_assert_int_eq(s21_create_matrix_ex(3, 3, S21_ALLOC_DEFAULT, &A), OK);
+  ck_assert_ptr_null(A.block);
+  s21_remove_matrix(&A);
+  ck_assert_int_ge(s21_numa_nodes(), 1);
+}
+END_TEST
+
+Suite *suite_create_matrix_ex(void) {
+  Suite *suite = suite_create("s21_create_matrix_ex");
+  TCase *tc_core = tcase_create("core_of_create_matrix_ex");
+  tcase_add_loop_test(tc_core, s21_create_matrix_ex_1, 0, 8);
+  tcase_add_test(tc_core, s21_create_matrix_ex_2);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_create_matrix_aligned_1) {
+  // success: 64-byte aligned rows, padded off the 4K aliasing stride
+  const int cols = _i ? rand() % 100 + 1 : 512;
+  matrix_t A = {0};
+  ck_assert_int_eq(s21_create_matrix_ex(7, cols, S21_ALLOC_ALIGNED, &A), OK);
+  FOR(7) ck_assert_int_eq((size_t)A.matrix[i] % S21_ALIGN, 0);
+  long ld = A.matrix[1] - A.matrix[0];
+  ck_assert_int_ge(ld, cols);
+  ck_assert_int_ne(ld * sizeof(double) % S21_ALIAS_STRIDE, 0);
+  if (!_i) ck_assert_int_eq(ld, 520);
+  FORS(7, cols) ck_assert_double_eq(A.matrix[i][j], 0);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_create_matrix_huge_1) {
+  // success: huge-page backed block above the threshold
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  int flags = S21_ALLOC_HUGE | S21_ALLOC_FIRST_TOUCH;
+  ck_assert_int_eq(s21_create_matrix_ex(600, 600, flags, &A), OK);
+  ck_assert_int_eq((size_t)A.block % S21_HUGE_PAGE, 0);
+  ck_assert_int_eq((size_t)A.matrix[599] % S21_ALIGN, 0);
+  s21_create_matrix(600, 600, &B);
+  A.matrix[599][599] = 3, B.matrix[599][599] = 4;
+  ck_assert_int_eq(s21_sum_matrix(&A, &B, &C), OK);
+  ck_assert_double_eq(C.matrix[599][599], 7);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+}
+END_TEST
+
+Suite *suite_create_matrix_aligned(void) {
+  Suite *suite = suite_create("s21_create_matrix_aligned");
+  TCase *tc_core = tcase_create("core_of_create_matrix_aligned");
+  tcase_add_loop_test(tc_core, s21_create_matrix_aligned_1, 0, 10);
+  tcase_add_test(tc_core, s21_create_matrix_huge_1);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_matrix_view_1) {
+  // success: kernels read a padded window in place
+  matrix_t A = {0};
+  matrix_t V = {0};
+  matrix_t copy = {0};
+  matrix_t result = {0};
+  matrix_t ref = {0};
+  s21_create_matrix_ex(10, 512, S21_ALLOC_ALIGNED, &A);
+  ck_assert_int_eq(A.ld, 520);
+  FORS(10, 512) A.matrix[i][j] = get_rand(-3, 3);
+  ck_assert_int_eq(s21_matrix_view(&A, 2, 100, 4, 4, &V), OK);
+  ck_assert_int_eq(V.ld, 520);
+  ck_assert_ptr_eq(V.matrix[0], A.block + 2 * 520 + 100);
+  s21_create_matrix(4, 4, &copy);
+  FORS(4, 4) copy.matrix[i][j] = A.matrix[2 + i][100 + j];
+  ck_assert_int_eq(s21_eq_matrix(&V, &copy), SUCCESS);
+  s21_mult_matrix(&V, &V, &result);
+  s21_mult_matrix(&copy, &copy, &ref);
+  ck_assert_int_eq(s21_eq_matrix(&result, &ref), SUCCESS);
+  double det = 0, det_ref = 0;
+  s21_determinant(&V, &det);
+  s21_determinant(&copy, &det_ref);
+  ck_assert_double_eq(det, det_ref);
+  V.matrix[0][0] = 42;  // writes go through to the parent
+  ck_assert_double_eq(A.matrix[2][100], 42);
+  s21_remove_matrix(&V);
+  ck_assert_ptr_nonnull(A.block);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&copy);
+  s21_remove_matrix(&result);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+START_TEST(s21_matrix_view_2) {
+  // failure with out-of-range windows; views of row-allocated matrices
+  matrix_t A = {0};
+  matrix_t V = {0};
+  matrix_t W = {0};
+  ck_assert_int_eq(s21_matrix_view(&A, 0, 0, 1, 1, &V), ERR_FAIL);
+  s21_create_matrix(3, 3, &A);
+  s21_initialize_matrix(&A, 1, 1);
+  ck_assert_int_eq(s21_matrix_view(&A, 2, 0, 2, 1, &V), ERR_CALC);
+  ck_assert_int_eq(s21_matrix_view(&A, 0, -1, 1, 1, &V), ERR_CALC);
+  ck_assert_int_eq(s21_matrix_view(&A, 0, 0, 0, 1, &V), ERR_CALC);
+  ck_assert_int_eq(s21_matrix_view(&A, 1, 1, 2, 2, &V), OK);
+  ck_assert_int_eq(s21_matrix_view(&V, 1, 0, 1, 2, &W), OK);
+  ck_assert_double_eq(W.matrix[0][1], 9);
+  ck_assert_int_eq(V.ld, 0);
+  s21_remove_matrix(&W);
+  s21_remove_matrix(&V);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+Suite *suite_matrix_view(void) {
+  Suite *suite = suite_create("s21_matrix_view");
+  TCase *tc_core = tcase_create("core_of_matrix_view");
+  tcase_add_test(tc_core, s21_matrix_view_1);
+  tcase_add_test(tc_core, s21_matrix_view_2);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_wrap_matrix_1) {
+  // success: borrowed buffer is read in place and left to the caller
+  double data[3 * 5] = {0};
+  FOR(15) data[i] = i;
+  matrix_t A = {0};
+  matrix_t T = {0};
+  ck_assert_int_eq(s21_wrap_matrix(data, 3, 4, 5, S21_WRAP_BORROW, &A), OK);
+  ck_assert_double_eq(A.matrix[2][3], 13);
+  ck_assert_int_eq(A.ld, 5);
+  ck_assert_int_eq(s21_transpose(&A, &T), OK);
+  ck_assert_double_eq(T.matrix[3][1], 8);
+  A.matrix[1][0] = -1;
+  ck_assert_double_eq(data[5], -1);
+  s21_remove_matrix(&A);
+  ck_assert_ptr_null(A.matrix);
+  ck_assert_double_eq(data[14], 14);
+  s21_remove_matrix(&T);
+}
+END_TEST
+
+START_TEST(s21_wrap_matrix_2) {
+  // success: owned buffer is freed by s21_remove_matrix
+  double *data = malloc(sizeof(double) * 6);
+  FOR(6) data[i] = i + 1;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  ck_assert_int_eq(s21_wrap_matrix(data, 2, 3, 0, S21_WRAP_OWN, &A), OK);
+  s21_create_matrix(3, 1, &B);
+  FOR(3) B.matrix[i][0] = 1;
+  ck_assert_int_eq(s21_mult_matrix(&A, &B, &C), OK);
+  ck_assert_double_eq(C.matrix[1][0], 15);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+}
+END_TEST
+
+START_TEST(s21_wrap_matrix_3) {
+  // failure with null buffer, bad dimensions and short stride
+  double data[4] = {0};
+  matrix_t A = {0};
+  ck_assert_int_eq(s21_wrap_matrix(NULL, 2, 2, 0, 0, &A), ERR_FAIL);
+  ck_assert_int_eq(s21_wrap_matrix(data, 0, 2, 0, 0, &A), ERR_FAIL);
+  ck_assert_int_eq(s21_wrap_matrix(data, 2, 2, 0, 0, NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_wrap_matrix(data, 2, 2, 1, 0, &A), ERR_CALC);
+}
+END_TEST
+
+Suite *suite_wrap_matrix(void) {
+  Suite *suite = suite_create("s21_wrap_matrix");
+  TCase *tc_core = tcase_create("core_of_wrap_matrix");
+  tcase_add_test(tc_core, s21_wrap_matrix_1);
+  tcase_add_test(tc_core, s21_wrap_matrix_2);
+  tcase_add_test(tc_core, s21_wrap_matrix_3);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_cancel_1) {
+  // cancelled token stops every cofactor routine with ERR_CANCEL
+  matrix_t A = {0};
+  matrix_t result = {0};
+  double det = 0;
+  s21_cancel_t token;
+  s21_cancel_init(&token, 0);
+  s21_create_matrix(6, 6, &A);
+  FORS(6, 6) A.matrix[i][j] = get_rand(-1, 1);
+  ck_assert_int_eq(s21_cancelled(&token), 0);
+  ck_assert_int_eq(s21_determinant_ex(&A, &det, &token), OK);
+  s21_cancel(&token);
+  ck_assert_int_eq(s21_determinant_ex(&A, &det, &token), ERR_CANCEL);
+  ck_assert_int_eq(s21_calc_complements_ex(&A, &result, &token), ERR_CANCEL);
+  ck_assert_ptr_null(result.matrix);
+  ck_assert_int_eq(s21_inverse_matrix_ex(&A, &result, &token), ERR_CANCEL);
+  ck_assert_int_eq(s21_determinant_mt(&A, &det, 2, &token), ERR_CANCEL);
+  ck_assert_int_eq(s21_calc_complements_mt(&A, &result, 2, &token),
+                   ERR_CANCEL);
+  ck_assert_ptr_null(result.matrix);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_cancel_2) {
+  // deadline interrupts a factorial-size expansion promptly
+  matrix_t A = {0};
+  matrix_t result = {0};
+  double det = 0;
+  s21_cancel_t token;
+  s21_create_matrix(14, 14, &A);
+  FORS(14, 14) A.matrix[i][j] = get_rand(-1, 1);
+  time_t start = time(NULL);
+  s21_cancel_init(&token, 0.05);
+  ck_assert_int_eq(s21_determinant_ex(&A, &det, &token), ERR_CANCEL);
+  s21_cancel_init(&token, 0.05);
+  ck_assert_int_eq(s21_calc_complements_mt(&A, &result, 0, &token),
+                   ERR_CANCEL);
+  ck_assert_int_le(time(NULL) - start, 2);
+  ck_assert_int_eq(s21_cancelled(NULL), 0);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+Suite *suite_cancel(void) {
+  Suite *suite = suite_create("s21_cancel");
+  TCase *tc_core = tcase_create("core_of_cancel");
+  tcase_add_test(tc_core, s21_cancel_1);
+  tcase_add_test(tc_core, s21_cancel_2);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+// triple-loop reference for the planner kernels
+static void s21_mult_ref(matrix_t *A, matrix_t *B, matrix_t *C) {
+  s21_create_matrix(A->rows, B->columns, C);
+  FORSZ(A->rows, B->columns, A->columns)
+  C->matrix[i][j] += A->matrix[i][k] * B->matrix[k][j];
+}
+
+START_TEST(s21_plan_1) {
+  // estimates and the default choices
+  matrix_t A = {0};
+  matrix_t B = {0};
+  s21_plan_t plan;
+  s21_tuning_set(NULL);
+  s21_create_matrix(3, 4, &A);
+  s21_create_matrix(4, 5, &B);
+  ck_assert_int_eq(s21_plan(S21_OP_MULT, &A, &B, &plan), OK);
+  ck_assert_int_eq(plan.algo, S21_ALGO_SMALL);
+  ck_assert_double_eq(plan.flops, 2 * 3 * 4 * 5);
+  ck_assert_double_eq(plan.scratch, 0);
+  ck_assert_int_eq(plan.threads, 1);
+  ck_assert_int_eq(s21_plan(S21_OP_MULT, &B, &A, &plan), ERR_CALC);
+  ck_assert_int_eq(s21_plan(S21_OP_DETERMINANT, &A, NULL, &plan), ERR_CALC);
+  ck_assert_int_eq(s21_plan(S21_OP_SUM, &A, NULL, &plan), ERR_FAIL);
+  ck_assert_int_eq(s21_plan(S21_OP_TRANSPOSE, &A, NULL, NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_plan(S21_OP_QR, &B, NULL, &plan), ERR_CALC);
+  ck_assert_int_eq(s21_plan(S21_OP_QR, &A, NULL, &plan), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_create_matrix(9, 9, &A);
+  s21_initialize_matrix(&A, 1, 1);
+  ck_assert_int_eq(s21_plan(S21_OP_DETERMINANT, &A, NULL, &plan), OK);
+  ck_assert_int_eq(plan.algo, S21_ALGO_COFACTOR);
+  ck_assert_double_gt(plan.scratch, 0);
+  ck_assert_str_eq(s21_algo_name(plan.algo), "cofactor");
+  s21_remove_matrix(&A);
+  s21_create_matrix(3, 3, &A);
+  s21_initialize_matrix(&A, 1, 1);
+  ck_assert_int_eq(s21_plan(S21_OP_INVERSE, &A, NULL, &plan), OK);
+  ck_assert_int_eq(plan.algo, S21_ALGO_COFACTOR);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+}
+END_TEST
+
+START_TEST(s21_plan_2) {
+  // blocked and threaded kernels match the triple loop bit for bit
+  const int m = rand() % 40 + 1, k = rand() % 40 + 1, n = rand() % 40 + 1;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  matrix_t ref = {0};
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.small_max = 0, t.block = 4 + _i, t.threaded_flops = 0, t.threads = _i;
+  s21_tuning_set(&t);
+  s21_create_matrix(m, k, &A);
+  s21_create_matrix(k, n, &B);
+  FORS(m, k) A.matrix[i][j] = get_rand(-10, 10);
+  FORS(k, n) B.matrix[i][j] = get_rand(-10, 10);
+  s21_plan_t plan;
+  s21_plan(S21_OP_MULT, &A, &B, &plan);
+  ck_assert_int_eq(plan.algo, _i > 1 && m > 1 ? S21_ALGO_THREADED
+                                              : S21_ALGO_BLOCKED);
+  ck_assert_int_eq(s21_mult_matrix(&A, &B, &C), OK);
+  s21_mult_ref(&A, &B, &ref);
+  FORS(m, n) ck_assert_double_eq(C.matrix[i][j], ref.matrix[i][j]);
+  s21_tuning_set(NULL);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+START_TEST(s21_plan_3) {
+  // Strassen on padded operands agrees within rounding
+  const int n = rand() % 40 + 20, m = n - rand() % 4, k = n - rand() % 4;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  matrix_t ref = {0};
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.strassen_leaf = 8, t.strassen_min = 16;
+  s21_tuning_set(&t);
+  s21_create_matrix(m, k, &A);
+  s21_create_matrix(k, n, &B);
+  FORS(m, k) A.matrix[i][j] = get_rand(-10, 10);
+  FORS(k, n) B.matrix[i][j] = get_rand(-10, 10);
+  s21_plan_t plan;
+  s21_plan(S21_OP_MULT, &A, &B, &plan);
+  ck_assert_int_eq(plan.algo, S21_ALGO_STRASSEN);
+  ck_assert_double_gt(plan.scratch, 0);
+  ck_assert_int_eq(s21_mult_matrix(&A, &B, &C), OK);
+  s21_mult_ref(&A, &B, &ref);
+  ck_assert_int_eq(s21_eq_matrix(&C, &ref), SUCCESS);
+  s21_tuning_set(NULL);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+START_TEST(s21_plan_4) {
+  // the public entry points keep cofactor bits, LU (opt-in) agrees within
+  // rounding and reports a numerically singular matrix
+  const int n = _i + 2;
+  matrix_t A = {0};
+  matrix_t inv = {0};
+  matrix_t ref = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = get_rand(-10, 10);
+  double det = 0, det_ref = 0;
+  ck_assert_int_eq(s21_determinant(&A, &det), OK);
+  ck_assert_int_eq(s21_determinant_ex(&A, &det_ref, NULL), OK);
+  ck_assert(det == det_ref);
+  ck_assert_int_eq(s21_lu_determinant(&A, &det), OK);
+  ck_assert_double_eq_tol(det, det_ref, 1e-6 * fabs(det_ref) + 1e-9);
+  ck_assert_int_eq(s21_lu_inverse(&A, &inv), OK);
+  ck_assert_int_eq(s21_inverse_matrix_ex(&A, &ref, NULL), OK);
+  ck_assert_int_eq(s21_eq_matrix(&inv, &ref), SUCCESS);
+  s21_remove_matrix(&inv);
+  s21_remove_matrix(&ref);
+  ck_assert_int_eq(s21_inverse_matrix(&A, &inv), OK);
+  ck_assert_int_eq(s21_inverse_matrix_ex(&A, &ref, NULL), OK);
+  FORS(n, n) ck_assert(inv.matrix[i][j] == ref.matrix[i][j]);
+  s21_remove_matrix(&inv);
+  FOR(n) A.matrix[n - 1][i] = A.matrix[0][i];  // singular
+  ck_assert_int_eq(s21_lu_determinant(&A, &det), OK);
+  ck_assert_double_eq(det, 0);
+  ck_assert_int_eq(s21_lu_inverse(&A, &inv), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+START_TEST(s21_plan_4_singular) {
+  // a[i][j] = i n + j + 1 has rank 2: det 0 and no inverse on every path
+  const int n = _i ? 8 : 5;
+  matrix_t A = {0};
+  matrix_t inv = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = i * n + j + 1;
+  double det = 1;
+  ck_assert_int_eq(s21_determinant(&A, &det), OK);
+  ck_assert_double_eq(det, 0);
+  ck_assert_int_eq(s21_inverse_matrix(&A, &inv), ERR_CALC);
+  det = 1;
+  ck_assert_int_eq(s21_lu_determinant(&A, &det), OK);
+  ck_assert_double_eq(det, 0);
+  ck_assert_int_eq(s21_lu_inverse(&A, &inv), ERR_CALC);
+  ck_assert_int_eq(s21_lu_solve(&A, &A, &inv), ERR_CALC);
+  ck_assert_ptr_null(inv.matrix);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_plan_5) {
+  // blocked transpose and a profile round trip
+  matrix_t A = {0};
+  matrix_t T = {0};
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.small_max = 2, t.transpose_block = 4, t.complements_mt_min = 6;
+  t.qr_block = 5;
+  s21_tuning_set(&t);
+  s21_create_matrix(11, 7, &A);
+  s21_initialize_matrix(&A, 1, 1);
+  ck_assert_int_eq(s21_transpose(&A, &T), OK);
+  FORS(11, 7) ck_assert_double_eq(T.matrix[j][i], A.matrix[i][j]);
+  s21_plan_t plan;
+  ck_assert_int_eq(s21_plan(S21_OP_QR, &A, NULL, &plan), OK);
+  ck_assert_int_eq(plan.block, 5);
+  char path[] = "/tmp/s21_profileXXXXXX";
+  int fd = mkstemp(path);
+  ck_assert_int_ne(fd, -1);
+  close(fd);
+  ck_assert_int_eq(s21_tuning_save(path), OK);
+  s21_tuning_set(NULL);
+  ck_assert_int_eq(s21_tuning_load(path), OK);
+  s21_tuning_t back;
+  s21_tuning_get(&back);
+  ck_assert_int_eq(back.transpose_block, 4);
+  ck_assert_int_eq(back.complements_mt_min, 6);
+  ck_assert_int_eq(back.qr_block, 5);
+  ck_assert_double_eq(back.threaded_flops, t.threaded_flops);
+  back.qr_block = 0;
+  s21_tuning_set(&back);
+  s21_tuning_get(&back);
+  ck_assert_int_eq(back.qr_block, 1);
+  ck_assert_int_eq(s21_tuning_load("/nonexistent/profile"), ERR_FAIL);
+  unlink(path);
+  s21_tuning_set(NULL);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&T);
+}
+END_TEST
+
+Suite *suite_plan(void) {
+  Suite *suite = suite_create("s21_plan");
+  TCase *tc_core = tcase_create("core_of_plan");
+  tcase_add_test(tc_core, s21_plan_1);
+  tcase_add_loop_test(tc_core, s21_plan_2, 0, 5);
+  tcase_add_loop_test(tc_core, s21_plan_3, 0, 5);
+  tcase_add_loop_test(tc_core, s21_plan_4, 0, 6);
+  tcase_add_loop_test(tc_core, s21_plan_4_singular, 0, 2);
+  tcase_add_test(tc_core, s21_plan_5);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_autotune_1) {
+  // the cache path is keyed by CPU model under XDG_CACHE_HOME
+  char path[512];
+  const char *saved = getenv("XDG_CACHE_HOME");
+  char *keep = saved ? strdup(saved) : NULL;
+  setenv("XDG_CACHE_HOME", "/tmp/s21_cache", 1);
+  int n = s21_tuning_path(path, sizeof(path));
+  ck_assert_int_eq(n, (int)strlen(path));
+  ck_assert_int_eq(strncmp(path, "/tmp/s21_cache/s21_matrix/", 26), 0);
+  ck_assert_str_eq(path + n - 5, ".conf");
+  ck_assert_ptr_null(strchr(path + 26, '/'));
+  ck_assert_ptr_null(strchr(path + 26, ' '));
+  ck_assert_int_eq(s21_tuning_path(path, 8), n);  // snprintf-like
+  ck_assert_int_eq(strlen(path), 7);
+  if (keep)
+    setenv("XDG_CACHE_HOME", keep, 1);
+  else
+    unsetenv("XDG_CACHE_HOME");
+  free(keep);
+}
+END_TEST
+
+START_TEST(s21_autotune_2) {
+  // a profile only overrides the keys it names, junk lines are skipped
+  char path[] = "/tmp/s21_profileXXXXXX";
+  int fd = mkstemp(path);
+  ck_assert_int_ne(fd, -1);
+  FILE *f = fdopen(fd, "w");
+  fprintf(f, "# tuned\nblock = 96\nunknown = 3\nnot a line\nthreads=2\n");
+  fclose(f);
+  s21_tuning_set(NULL);
+  ck_assert_int_eq(s21_tuning_load(path), OK);
+  s21_tuning_t t, stock;
+  s21_tuning_get(&t);
+  s21_tuning_defaults(&stock);
+  ck_assert_int_eq(t.block, 96);
+  ck_assert_int_eq(t.threads, 2);
+  ck_assert_int_eq(t.small_max, stock.small_max);
+  ck_assert_int_eq(t.complements_mt_min, stock.complements_mt_min);
+  unlink(path);
+  s21_tuning_set(NULL);
+}
+END_TEST
+
+START_TEST(s21_autotune_3) {
+  // thresholds only move work around: a cache from before cofactor_max
+  // was dropped, with every cut-over low, leaves det and inverse as is
+  int n = _i;
+  matrix_t A = {0};
+  matrix_t inv = {0};
+  matrix_t ref = {0};
+  double det = 0, want = 0;
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = (double)((i * 7 + j * 3) % 11) - 5 + (i == j);
+  s21_tuning_set(NULL);
+  s21_determinant(&A, &want);
+  int status = s21_inverse_matrix(&A, &ref);
+  char path[] = "/tmp/s21_profileXXXXXX";
+  int fd = mkstemp(path);
+  ck_assert_int_ne(fd, -1);
+  FILE *f = fdopen(fd, "w");
+  fprintf(f, "cofactor_max = 2\nsmall_max = 0\nthreaded_flops = 1\n");
+  fprintf(f, "threads = 3\ncomplements_mt_min = 2\n");
+  fclose(f);
+  ck_assert_int_eq(s21_tuning_load(path), OK);
+  ck_assert_int_eq(s21_determinant(&A, &det), OK);
+  ck_assert(det == want);
+  ck_assert_int_eq(s21_inverse_matrix(&A, &inv), status);
+  if (!status) FORS(n, n) ck_assert(inv.matrix[i][j] == ref.matrix[i][j]);
+  s21_remove_matrix(&inv);
+  FORS(n, n) A.matrix[i][j] = i * n + j + 1;  // singular from n = 3
+  ck_assert_int_eq(s21_determinant(&A, &det), OK);
+  if (n > 2) ck_assert_double_eq(det, 0);
+  if (n > 2) ck_assert_int_eq(s21_inverse_matrix(&A, &inv), ERR_CALC);
+  unlink(path);
+  s21_tuning_set(NULL);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+Suite *suite_autotune(void) {
+  Suite *suite = suite_create("s21_autotune");
+  TCase *tc_core = tcase_create("core_of_autotune");
+  tcase_add_test(tc_core, s21_autotune_1);
+  tcase_add_test(tc_core, s21_autotune_2);
+  tcase_add_loop_test(tc_core, s21_autotune_3, 2, 9);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_accumulate_1) {
+  // cancellation: the fast sum loses the 1 hidden under 1e16
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  s21_create_matrix(1, 4, &A);
+  s21_create_matrix(4, 1, &B);
+  A.matrix[0][0] = 1e16, A.matrix[0][1] = 1;
+  A.matrix[0][2] = -1e16, A.matrix[0][3] = 1;
+  FOR(4) B.matrix[i][0] = 1;
+  ck_assert_int_eq(s21_mult_matrix_ex(&A, &B, &C, S21_ACC_FAST), OK);
+  ck_assert_double_eq(C.matrix[0][0], 1);
+  s21_remove_matrix(&C);
+  ck_assert_int_eq(s21_mult_matrix_ex(&A, &B, &C, S21_ACC_DOT2), OK);
+  ck_assert_double_eq(C.matrix[0][0], 2);
+  s21_remove_matrix(&C);
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.accumulate = S21_ACC_DOT2;
+  s21_tuning_set(&t);
+  ck_assert_int_eq(s21_mult_matrix(&A, &B, &C), OK);
+  ck_assert_double_eq(C.matrix[0][0], 2);
+  s21_plan_t plan;
+  s21_plan(S21_OP_MULT, &A, &B, &plan);
+  ck_assert_int_eq(plan.accumulate, S21_ACC_DOT2);
+  ck_assert_int_eq(plan.algo, S21_ALGO_BLOCKED);
+  ck_assert_double_gt(plan.scratch, 0);
+  s21_tuning_set(NULL);
+  s21_remove_matrix(&C);
+  ck_assert_int_eq(s21_mult_matrix_ex(&A, &B, &C, 7), ERR_FAIL);
+  ck_assert_int_eq(s21_mult_matrix_ex(&A, &A, &C, S21_ACC_DOT2), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+}
+END_TEST
+
+START_TEST(s21_accumulate_2) {
+  // a million terms: pairwise and Dot2 stay close, the fast sum drifts
+  const int k = 1 << 20;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t fast = {0};
+  matrix_t pair = {0};
+  matrix_t dot2 = {0};
+  s21_create_matrix(1, k, &A);
+  s21_create_matrix(k, 1, &B);
+  FOR(k) A.matrix[0][i] = 0.1, B.matrix[i][0] = get_rand(0, 1);
+  s21_mult_matrix_ex(&A, &B, &fast, S21_ACC_FAST);
+  s21_mult_matrix_ex(&A, &B, &pair, S21_ACC_PAIRWISE);
+  s21_mult_matrix_ex(&A, &B, &dot2, S21_ACC_DOT2);
+  double ref = dot2.matrix[0][0];
+  double err_fast = fabs(fast.matrix[0][0] - ref) / ref;
+  double err_pair = fabs(pair.matrix[0][0] - ref) / ref;
+  ck_assert_double_lt(err_pair, 1e-14);
+  ck_assert_double_le(err_pair, err_fast);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&fast);
+  s21_remove_matrix(&pair);
+  s21_remove_matrix(&dot2);
+}
+END_TEST
+
+START_TEST(s21_accumulate_3) {
+  // every mode, serial and threaded, agrees with the triple loop
+  const int m = rand() % 30 + 1, k = rand() % 300 + 1, n = rand() % 30 + 1;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  matrix_t ref = {0};
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.block = 4 + _i % 3 * 8, t.threads = _i % 3 + 1, t.threaded_flops = 0;
+  s21_tuning_set(&t);
+  s21_create_matrix(m, k, &A);
+  s21_create_matrix(k, n, &B);
+  FORS(m, k) A.matrix[i][j] = get_rand(-10, 10);
+  FORS(k, n) B.matrix[i][j] = get_rand(-10, 10);
+  s21_mult_ref(&A, &B, &ref);
+  ck_assert_int_eq(s21_mult_matrix_ex(&A, &B, &C, _i % 2 + 1), OK);
+  ck_assert_int_eq(s21_eq_matrix(&C, &ref), SUCCESS);
+  s21_tuning_set(NULL);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+Suite *suite_accumulate(void) {
+  Suite *suite = suite_create("s21_accumulate");
+  TCase *tc_core = tcase_create("core_of_accumulate");
+  tcase_add_test(tc_core, s21_accumulate_1);
+  tcase_add_test(tc_core, s21_accumulate_2);
+  tcase_add_loop_test(tc_core, s21_accumulate_3, 0, 6);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_matrix_pow_1) {
+  // success: A^k against repeated multiplication, k = 0..9
+  const int n = rand() % 6 + 1, k = _i;
+  matrix_t A = {0};
+  matrix_t P = {0};
+  matrix_t ref = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = get_rand(-1, 1);
+  s21_create_matrix(n, n, &ref);
+  FOR(n) ref.matrix[i][i] = 1;
+  for (int p = 0; p < k; p++) {
+    matrix_t next = {0};
+    s21_mult_matrix(&ref, &A, &next);
+    s21_remove_matrix(&ref);
+    ref = next;
+  }
+  ck_assert_int_eq(s21_matrix_pow(&A, k, &P), OK);
+  ck_assert_int_eq(s21_eq_matrix(&P, &ref), SUCCESS);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&P);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+START_TEST(s21_matrix_pow_2) {
+  // negative powers, a Markov chain a million steps out, errors
+  matrix_t A = {0};
+  matrix_t P = {0};
+  matrix_t inv = {0};
+  matrix_t ref = {0};
+  s21_create_matrix(3, 3, &A);
+  double m[3][3] = {{0.9, 0.075, 0.025}, {0.15, 0.8, 0.05}, {0.25, 0.25, 0.5}};
+  FORS(3, 3) A.matrix[i][j] = m[i][j];
+  ck_assert_int_eq(s21_matrix_pow(&A, -2, &P), OK);
+  s21_inverse_matrix(&A, &inv);
+  s21_mult_matrix(&inv, &inv, &ref);
+  ck_assert_int_eq(s21_eq_matrix(&P, &ref), SUCCESS);
+  s21_remove_matrix(&P);
+  ck_assert_int_eq(s21_matrix_pow(&A, 1000000, &P), OK);
+  double pi[3] = {0.625, 0.3125, 0.0625};  // stationary distribution
+  FORS(3, 3) ck_assert_double_eq_tol(P.matrix[i][j], pi[j], 1e-9);
+  s21_remove_matrix(&P);
+  ck_assert_int_eq(s21_matrix_pow(NULL, 2, &P), ERR_FAIL);
+  FOR(3) A.matrix[2][i] = 0;
+  ck_assert_int_eq(s21_matrix_pow(&A, -1, &P), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_create_matrix(2, 3, &A);
+  ck_assert_int_eq(s21_matrix_pow(&A, 2, &P), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&inv);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+START_TEST(s21_matrix_exp_1) {
+  // closed forms: diagonal, nilpotent, rotation
+  matrix_t A = {0};
+  matrix_t E = {0};
+  s21_create_matrix(3, 3, &A);
+  A.matrix[0][0] = 1, A.matrix[1][1] = -2.5, A.matrix[2][2] = 10;
+  ck_assert_int_eq(s21_matrix_exp(&A, &E), OK);
+  FORS(3, 3)
+  ck_assert_double_eq_tol(E.matrix[i][j], i == j ? exp(A.matrix[i][i]) : 0,
+                          1e-12 * exp(10));
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&E);
+  s21_create_matrix(2, 2, &A);
+  A.matrix[0][1] = 1;
+  ck_assert_int_eq(s21_matrix_exp(&A, &E), OK);
+  ck_assert_double_eq_tol(E.matrix[0][0], 1, 1e-15);
+  ck_assert_double_eq_tol(E.matrix[0][1], 1, 1e-15);
+  ck_assert_double_eq_tol(E.matrix[1][0], 0, 1e-15);
+  s21_remove_matrix(&E);
+  A.matrix[0][1] = -3, A.matrix[1][0] = 3;
+  ck_assert_int_eq(s21_matrix_exp(&A, &E), OK);
+  ck_assert_double_eq_tol(E.matrix[0][0], cos(3), 1e-13);
+  ck_assert_double_eq_tol(E.matrix[0][1], -sin(3), 1e-13);
+  ck_assert_double_eq_tol(E.matrix[1][0], sin(3), 1e-13);
+  s21_remove_matrix(&E);
+  A.matrix[0][0] = INFINITY;
+  ck_assert_int_eq(s21_matrix_exp(&A, &E), ERR_CALC);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_matrix_exp_2) {
+  // e^A e^-A = I for random A
+  const int n = rand() % 8 + 1;
+  matrix_t A = {0};
+  matrix_t neg = {0};
+  matrix_t E = {0};
+  matrix_t F = {0};
+  matrix_t I = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = get_rand(-2, 2);
+  s21_mult_number(&A, -1, &neg);
+  ck_assert_int_eq(s21_matrix_exp(&A, &E), OK);
+  ck_assert_int_eq(s21_matrix_exp(&neg, &F), OK);
+  s21_mult_matrix(&E, &F, &I);
+  FORS(n, n) ck_assert_double_eq_tol(I.matrix[i][j], i == j, 1e-9);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&neg);
+  s21_remove_matrix(&E);
+  s21_remove_matrix(&F);
+  s21_remove_matrix(&I);
+}
+END_TEST
+
+Suite *suite_matrix_pow(void) {
+  Suite *suite = suite_create("s21_matrix_pow");
+  TCase *tc_core = tcase_create("core_of_matrix_pow");
+  tcase_add_loop_test(tc_core, s21_matrix_pow_1, 0, 10);
+  tcase_add_test(tc_core, s21_matrix_pow_2);
+  tcase_add_test(tc_core, s21_matrix_exp_1);
+  tcase_add_loop_test(tc_core, s21_matrix_exp_2, 0, 10);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_band_1) {
+  // banded multiply, solve and determinant against the dense routines
+  const int n = rand() % 20 + 1, kl = _i % 3, ku = (_i + 1) % 4, m = 3;
+  matrix_t A = {0};
+  matrix_t X = {0};
+  matrix_t ref = {0};
+  matrix_t got = {0};
+  matrix_t back = {0};
+  s21_band_t B = {0};
+  s21_create_matrix(n, n, &A);
+  s21_create_matrix(n, m, &X);
+  FORS(n, n) if (j - i <= ku && i - j <= kl) A.matrix[i][j] = get_rand(-1, 1);
+  FOR(n) A.matrix[i][i] += 4;  // diagonally dominant
+  FORS(n, m) X.matrix[i][j] = get_rand(-10, 10);
+  ck_assert_int_eq(s21_band_from_matrix(&A, kl, ku, &B), OK);
+  ck_assert_int_eq(s21_band_mult(&B, &X, &got), OK);
+  s21_mult_matrix(&A, &X, &ref);
+  ck_assert_int_eq(s21_eq_matrix(&got, &ref), SUCCESS);
+  s21_remove_matrix(&got);
+  ck_assert_int_eq(s21_band_solve(&B, &ref, &got), OK);
+  ck_assert_int_eq(s21_eq_matrix(&got, &X), SUCCESS);
+  double det = 0, det_ref = 0;
+  ck_assert_int_eq(s21_band_determinant(&B, &det), OK);
+  s21_lu_determinant(&A, &det_ref);
+  ck_assert_double_eq_tol(det, det_ref, 1e-9 * fabs(det_ref));
+  ck_assert_int_eq(s21_band_to_matrix(&B, &back), OK);
+  ck_assert_int_eq(s21_eq_matrix(&back, &A), SUCCESS);
+  s21_remove_band(&B);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&X);
+  s21_remove_matrix(&ref);
+  s21_remove_matrix(&got);
+  s21_remove_matrix(&back);
+}
+END_TEST
+
+START_TEST(s21_band_2) {
+  // compact storage, bounds and the errors
+  s21_band_t T = {0};
+  matrix_t A = {0};
+  matrix_t X = {0};
+  matrix_t R = {0};
+  ck_assert_int_eq(s21_create_triangular(5, S21_UPPER, &T), OK);
+  ck_assert_int_eq(T.row[1] - T.row[0], 5);
+  ck_assert_int_eq(T.row[4] - T.row[0], 5 + 4 + 3 + 2);
+  ck_assert_ptr_null(s21_band_at(&T, 3, 2));
+  ck_assert_ptr_nonnull(s21_band_at(&T, 2, 4));
+  FOR(5) *s21_band_at(&T, i, i) = i + 1;
+  double det = 0;
+  ck_assert_int_eq(s21_band_determinant(&T, &det), OK);
+  ck_assert_double_eq(det, 120);
+  *s21_band_at(&T, 2, 2) = 0;
+  s21_create_matrix(5, 1, &X);
+  ck_assert_int_eq(s21_band_solve(&T, &X, &R), ERR_CALC);
+  s21_remove_band(&T);
+  ck_assert_int_eq(s21_create_band(4, 1, 1, &T), OK);
+  ck_assert_int_eq(T.row[3] - T.row[0], 2 + 3 + 3);
+  s21_create_matrix(4, 4, &A);
+  A.matrix[3][0] = 1;
+  ck_assert_int_eq(s21_band_from_matrix(&A, 1, 1, &T), ERR_CALC);
+  ck_assert_int_eq(s21_band_mult(&T, &X, &R), ERR_CALC);
+  ck_assert_int_eq(s21_create_triangular(4, 7, &T), ERR_FAIL);
+  ck_assert_int_eq(s21_create_band(0, 1, 1, &T), ERR_FAIL);
+  s21_remove_band(&T);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&X);
+}
+END_TEST
+
+START_TEST(s21_band_3) {
+  // dense triangular input takes the diagonal product and substitution
+  const int n = _i + 2;
+  matrix_t A = {0};
+  matrix_t inv = {0};
+  matrix_t ref = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) if ((_i % 2 ? i <= j : i >= j)) A.matrix[i][j] = get_rand(1, 2);
+  s21_plan_t plan;
+  s21_plan(S21_OP_DETERMINANT, &A, NULL, &plan);
+  ck_assert_int_eq(plan.algo, S21_ALGO_TRIANGULAR);
+  double det = 0, prod = 1;
+  FOR(n) prod *= A.matrix[i][i];
+  ck_assert_int_eq(s21_determinant(&A, &det), OK);
+  ck_assert_double_eq(det, prod);
+  ck_assert_int_eq(s21_inverse_matrix(&A, &inv), OK);
+  s21_lu_inverse(&A, &ref);
+  ck_assert_int_eq(s21_eq_matrix(&inv, &ref), SUCCESS);
+  s21_remove_matrix(&inv);
+  A.matrix[n - 1][n - 1] = 0;
+  ck_assert_int_eq(s21_inverse_matrix(&A, &inv), ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&ref);
+}
+END_TEST
+
+Suite *suite_band(void) {
+  Suite *suite = suite_create("s21_band");
+  TCase *tc_core = tcase_create("core_of_band");
+  tcase_add_loop_test(tc_core, s21_band_1, 0, 12);
+  tcase_add_test(tc_core, s21_band_2);
+  tcase_add_loop_test(tc_core, s21_band_3, 0, 8);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_gemv_1) {
+  // y = alpha op(A) x + beta y against s21_mult_matrix on column matrices
+  const int m = rand() % 40 + 1, n = rand() % 40 + 1, trans = _i % 2;
+  const double alpha = get_rand(-2, 2), beta = _i % 3 ? get_rand(-2, 2) : 0;
+  matrix_t A = {0};
+  matrix_t op = {0};
+  matrix_t col = {0};
+  matrix_t ref = {0};
+  s21_vector_t x = {0};
+  s21_vector_t y = {0};
+  s21_create_matrix(m, n, &A);
+  FORS(m, n) A.matrix[i][j] = get_rand(-10, 10);
+  if (trans)
+    s21_transpose(&A, &op);
+  else
+    s21_transpose(&A, &ref), s21_transpose(&ref, &op), s21_remove_matrix(&ref);
+  s21_create_vector(op.columns, &x);
+  s21_create_vector(op.rows, &y);
+  s21_create_matrix(op.columns, 1, &col);
+  FOR(x.size) x.data[i] = col.matrix[i][0] = get_rand(-10, 10);
+  FOR(y.size) y.data[i] = get_rand(-10, 10);
+  s21_mult_matrix(&op, &col, &ref);
+  FOR(y.size) ref.matrix[i][0] = alpha * ref.matrix[i][0] + beta * y.data[i];
+  ck_assert_int_eq(s21_gemv(trans, alpha, &A, &x, beta, &y), OK);
+  FOR(y.size) ck_assert_double_eq_tol(y.data[i], ref.matrix[i][0], 1e-9);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&op);
+  s21_remove_matrix(&col);
+  s21_remove_matrix(&ref);
+  s21_remove_vector(&x);
+  s21_remove_vector(&y);
+}
+END_TEST
+
+START_TEST(s21_gemv_2) {
+  // every thread count gives bit-identical output
+  const int m = rand() % 200 + 1, n = rand() % 200 + 1, trans = _i % 2;
+  matrix_t A = {0};
+  s21_vector_t x = {0};
+  s21_vector_t serial = {0};
+  s21_vector_t threaded = {0};
+  s21_create_matrix(m, n, &A);
+  FORS(m, n) A.matrix[i][j] = get_rand(-10, 10);
+  s21_create_vector(trans ? m : n, &x);
+  s21_create_vector(trans ? n : m, &serial);
+  s21_create_vector(trans ? n : m, &threaded);
+  FOR(x.size) x.data[i] = get_rand(-10, 10);
+  FOR(serial.size) serial.data[i] = threaded.data[i] = get_rand(-1, 1);
+  ck_assert_int_eq(s21_gemv(trans, 1.5, &A, &x, 0.5, &serial), OK);
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.threads = _i / 2 + 2, t.threaded_flops = 0;
+  s21_tuning_set(&t);
+  s21_plan_t plan;
+  s21_plan(S21_OP_GEMV, &A, NULL, &plan);
+  ck_assert_int_eq(plan.algo, S21_ALGO_THREADED);
+  ck_assert_int_eq(s21_gemv(trans, 1.5, &A, &x, 0.5, &threaded), OK);
+  FOR(serial.size) ck_assert_double_eq(serial.data[i], threaded.data[i]);
+  s21_tuning_set(NULL);
+  s21_remove_matrix(&A);
+  s21_remove_vector(&x);
+  s21_remove_vector(&serial);
+  s21_remove_vector(&threaded);
+}
+END_TEST
+
+START_TEST(s21_gemv_3) {
+  // alignment, beta = 0 ignores y, errors
+  matrix_t A = {0};
+  s21_vector_t x = {0};
+  s21_vector_t y = {0};
+  s21_create_matrix(3, 2, &A);
+  s21_initialize_matrix(&A, 1, 1);
+  ck_assert_int_eq(s21_create_vector(2, &x), OK);
+  ck_assert_int_eq(s21_create_vector(3, &y), OK);
+  ck_assert_int_eq((size_t)x.data % S21_ALIGN, 0);
+  x.data[0] = 1, x.data[1] = -1;
+  FOR(3) y.data[i] = NAN;
+  ck_assert_int_eq(s21_gemv(S21_NO_TRANS, 2, &A, &x, 0, &y), OK);
+  FOR(3) ck_assert_double_eq(y.data[i], -2);
+  ck_assert_int_eq(s21_gemv(S21_TRANS, 1, &A, &x, 0, &y), ERR_CALC);
+  ck_assert_int_eq(s21_gemv(S21_TRANS, 1, &A, &y, 0, &x), OK);
+  ck_assert_double_eq(x.data[0], -2 * (1 + 3 + 5));
+  ck_assert_int_eq(s21_gemv(5, 1, &A, &x, 0, &y), ERR_FAIL);
+  ck_assert_int_eq(s21_gemv(S21_NO_TRANS, 1, NULL, &x, 0, &y), ERR_FAIL);
+  ck_assert_int_eq(s21_create_vector(0, &x), ERR_FAIL);
+  s21_remove_matrix(&A);
+  s21_remove_vector(&x);
+  s21_remove_vector(&y);
+}
+END_TEST
+
+Suite *suite_gemv(void) {
+  Suite *suite = suite_create("s21_gemv");
+  TCase *tc_core = tcase_create("core_of_gemv");
+  tcase_add_loop_test(tc_core, s21_gemv_1, 0, 12);
+  tcase_add_loop_test(tc_core, s21_gemv_2, 0, 6);
+  tcase_add_test(tc_core, s21_gemv_3);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_reduce_1) {
+  // every reduction against a plain loop, across several row chunks
+  const int m = rand() % 300 + 1, n = rand() % 30 + 1;
+  matrix_t A = {0};
+  s21_vector_t rows = {0};
+  s21_vector_t cols = {0};
+  s21_create_matrix(m, n, &A);
+  FORS(m, n) A.matrix[i][j] = get_rand(-100, 100);
+  double fro = 0, inf = 0, one = 0, amax = 0, lo = INFINITY, hi = -INFINITY;
+  ck_assert_int_eq(s21_row_sums(&A, &rows), OK);
+  ck_assert_int_eq(s21_column_sums(&A, &cols), OK);
+  ck_assert_int_eq(rows.size, m);
+  ck_assert_int_eq(cols.size, n);
+  FOR(m) {
+    double sum = 0, abs_sum = 0;
+    for (int j = 0; j < n; j++) {
+      double v = A.matrix[i][j];
+      sum += v, abs_sum += fabs(v), fro += v * v;
+      amax = fmax(amax, fabs(v)), lo = fmin(lo, v), hi = fmax(hi, v);
+    }
+    inf = fmax(inf, abs_sum);
+    ck_assert_double_eq_tol(rows.data[i], sum, 1e-9);
+  }
+  for (int j = 0; j < n; j++) {
+    double sum = 0, abs_sum = 0;
+    FOR(m) sum += A.matrix[i][j], abs_sum += fabs(A.matrix[i][j]);
+    one = fmax(one, abs_sum);
+    ck_assert_double_eq_tol(cols.data[j], sum, 1e-9);
+  }
+  double r = 0, r2 = 0;
+  s21_norm(&A, S21_NORM_1, &r);
+  ck_assert_double_eq_tol(r, one, 1e-9);
+  s21_norm(&A, S21_NORM_INF, &r);
+  ck_assert_double_eq_tol(r, inf, 1e-9);
+  s21_norm(&A, S21_NORM_FRO, &r);
+  ck_assert_double_eq_tol(r, sqrt(fro), 1e-9);
+  s21_norm(&A, S21_NORM_MAX, &r);
+  ck_assert_double_eq(r, amax);
+  ck_assert_int_eq(s21_min_max(&A, &r, &r2), OK);
+  ck_assert_double_eq(r, lo);
+  ck_assert_double_eq(r2, hi);
+  ck_assert_int_eq(s21_trace(&A, &r), m == n ? OK : ERR_CALC);
+  s21_remove_matrix(&A);
+  s21_remove_vector(&rows);
+  s21_remove_vector(&cols);
+}
+END_TEST
+
+START_TEST(s21_reduce_2) {
+  // any thread count reproduces the serial bits
+  const int m = rand() % 500 + 100, n = rand() % 40 + 1;
+  matrix_t A = {0};
+  s21_create_matrix(m, n, &A);
+  FORS(m, n) A.matrix[i][j] = get_rand(-1e3, 1e3);
+  double serial[6], threaded[6];
+  s21_vector_t rows[2] = {0}, cols[2] = {0};
+  for (int run = 0; run < 2; run++) {
+    double *out = run ? threaded : serial;
+    if (run) {
+      s21_tuning_t t;
+      s21_tuning_defaults(&t);
+      t.threads = _i + 2, t.threaded_flops = 0;
+      s21_tuning_set(&t);
+      s21_plan_t plan;
+      s21_plan(S21_OP_REDUCE, &A, NULL, &plan);
+      ck_assert_int_eq(plan.algo, S21_ALGO_THREADED);
+    }
+    FOR(4) s21_norm(&A, i, &out[i]);
+    s21_min_max(&A, &out[4], &out[5]);
+    s21_row_sums(&A, &rows[run]);
+    s21_column_sums(&A, &cols[run]);
+  }
+  s21_tuning_set(NULL);
+  FOR(6) ck_assert_double_eq(serial[i], threaded[i]);
+  FOR(m) ck_assert_double_eq(rows[0].data[i], rows[1].data[i]);
+  FOR(n) ck_assert_double_eq(cols[0].data[i], cols[1].data[i]);
+  FOR(2) s21_remove_vector(&rows[i]), s21_remove_vector(&cols[i]);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_reduce_3) {
+  // Frobenius rescaling, NaN, trace and errors
+  matrix_t A = {0};
+  s21_create_matrix(3, 3, &A);
+  double r = 0, r2 = 0;
+  s21_initialize_matrix(&A, 1, 1);
+  ck_assert_int_eq(s21_trace(&A, &r), OK);
+  ck_assert_double_eq(r, 1 + 5 + 9);
+  FORS(3, 3) A.matrix[i][j] = 1e300;
+  s21_norm(&A, S21_NORM_FRO, &r);
+  ck_assert_double_eq_tol(r / 3e300, 1, 1e-12);
+  FORS(3, 3) A.matrix[i][j] = -1e-300;
+  s21_norm(&A, S21_NORM_FRO, &r);
+  ck_assert_double_eq_tol(r / 3e-300, 1, 1e-12);
+  FORS(3, 3) A.matrix[i][j] = 0;
+  s21_norm(&A, S21_NORM_FRO, &r);
+  ck_assert_double_eq(r, 0);
+  A.matrix[1][1] = NAN, A.matrix[2][0] = -7, A.matrix[0][2] = 4;
+  ck_assert_int_eq(s21_min_max(&A, &r, &r2), OK);
+  ck_assert_double_eq(r, -7);
+  ck_assert_double_eq(r2, 4);
+  FOR(4) {
+    ck_assert_int_eq(s21_norm(&A, i, &r), OK);
+    ck_assert(is_nan(r));
+  }
+  FORS(3, 3) A.matrix[i][j] = NAN;
+  ck_assert_int_eq(s21_min_max(&A, &r, &r2), ERR_CALC);
+  ck_assert_int_eq(s21_norm(&A, 4, &r), ERR_FAIL);
+  ck_assert_int_eq(s21_norm(NULL, S21_NORM_1, &r), ERR_FAIL);
+  ck_assert_int_eq(s21_min_max(&A, NULL, &r2), ERR_FAIL);
+  ck_assert_int_eq(s21_row_sums(&A, NULL), ERR_FAIL);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_cond_1) {
+  // the estimate is a lower bound that is almost always exact
+  const int n = rand() % 30 + 1;
+  matrix_t A = {0};
+  matrix_t inv = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = get_rand(-10, 10);
+  double est = 0, na = 0, ni = 0;
+  ck_assert_int_eq(s21_cond_estimate(&A, &est), OK);
+  s21_lu_inverse(&A, &inv);
+  s21_norm(&A, S21_NORM_1, &na);
+  s21_norm(&inv, S21_NORM_1, &ni);
+  ck_assert(est <= na * ni * (1 + 1e-9));
+  ck_assert(est >= na * ni / 3);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&inv);
+}
+END_TEST
+
+START_TEST(s21_cond_2) {
+  matrix_t A = {0};
+  s21_create_matrix(4, 4, &A);
+  double est = 0;
+  FOR(4) A.matrix[i][i] = 1;
+  ck_assert_int_eq(s21_cond_estimate(&A, &est), OK);
+  ck_assert_double_eq_tol(est, 1, 1e-15);
+  A.matrix[3][3] = 1e-8;
+  ck_assert_int_eq(s21_cond_estimate(&A, &est), OK);
+  ck_assert_double_eq_tol(est, 1e8, 1e-4);
+  A.matrix[3][3] = 0;
+  ck_assert_int_eq(s21_cond_estimate(&A, &est), OK);
+  ck_assert(is_inf(est));
+  s21_remove_matrix(&A);
+  s21_create_matrix(2, 3, &A);
+  ck_assert_int_eq(s21_cond_estimate(&A, &est), ERR_CALC);
+  ck_assert_int_eq(s21_cond_estimate(NULL, &est), ERR_FAIL);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+Suite *suite_reduce(void) {
+  Suite *suite = suite_create("s21_reduce");
+  TCase *tc_core = tcase_create("core_of_reduce");
+  tcase_add_loop_test(tc_core, s21_reduce_1, 0, 12);
+  tcase_add_loop_test(tc_core, s21_reduce_2, 0, 4);
+  tcase_add_test(tc_core, s21_reduce_3);
+  tcase_add_loop_test(tc_core, s21_cond_1, 0, 20);
+  tcase_add_test(tc_core, s21_cond_2);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+// random symmetric n x n, only the lower triangle filled when lower
+static void s21_fill_sym(matrix_t *A, int n, int lower) {
+  s21_create_matrix(n, n, A);
+  FOR(n) for (int j = 0; j <= i; j++) {
+    A->matrix[i][j] = get_rand(-10, 10);
+    if (!lower) A->matrix[j][i] = A->matrix[i][j];
+  }
+}
+
+START_TEST(s21_eigen_1) {
+  // A V = V diag(w), V^T V = I, ascending w, trace preserved
+  const int n = rand() % 40 + 1;
+  matrix_t A = {0};
+  matrix_t V = {0};
+  matrix_t VtV = {0};
+  matrix_t Vt = {0};
+  s21_vector_t w = {0};
+  s21_fill_sym(&A, n, 0);
+  ck_assert_int_eq(s21_eigen_sym(&A, &w, &V), OK);
+  ck_assert_int_eq(w.size, n);
+  ck_assert_int_eq(V.rows, n);
+  double trace = 0, sum = 0;
+  s21_trace(&A, &trace);
+  FOR(n) {
+    sum += w.data[i];
+    if (i) ck_assert(w.data[i - 1] <= w.data[i]);
+    for (int j = 0; j < n; j++) {
+      double av = 0;
+      for (int k = 0; k < n; k++) av += A.matrix[j][k] * V.matrix[k][i];
+      ck_assert_double_eq_tol(av, w.data[i] * V.matrix[j][i], 1e-9);
+    }
+  }
+  ck_assert_double_eq_tol(sum, trace, 1e-9);
+  s21_transpose(&V, &Vt);
+  s21_mult_matrix(&Vt, &V, &VtV);
+  FORS(n, n) ck_assert_double_eq_tol(VtV.matrix[i][j], i == j, 1e-12);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&V);
+  s21_remove_matrix(&Vt);
+  s21_remove_matrix(&VtV);
+  s21_remove_vector(&w);
+}
+END_TEST
+
+START_TEST(s21_eigen_2) {
+  // the upper triangle is never read; values alone match, bit for bit
+  const int n = rand() % 60 + 3;
+  matrix_t A = {0};
+  matrix_t L = {0};
+  matrix_t V = {0};
+  s21_vector_t w = {0};
+  s21_vector_t w2 = {0};
+  s21_fill_sym(&A, n, 0);
+  s21_create_matrix(n, n, &L);
+  FOR(n) for (int j = 0; j <= i; j++) L.matrix[i][j] = A.matrix[i][j];
+  FOR(n) for (int j = i + 1; j < n; j++) L.matrix[i][j] = NAN;
+  ck_assert_int_eq(s21_eigen_sym(&A, &w, &V), OK);
+  ck_assert_int_eq(s21_eigen_sym(&L, &w2, NULL), OK);
+  FOR(n) ck_assert_double_eq(w.data[i], w2.data[i]);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&L);
+  s21_remove_matrix(&V);
+  s21_remove_vector(&w);
+  s21_remove_vector(&w2);
+}
+END_TEST
+
+START_TEST(s21_eigen_3) {
+  // threaded steps, sweeps and back-transform reproduce the serial bits
+  const int n = 300 + _i * 37;
+  matrix_t A = {0};
+  matrix_t V[2] = {0};
+  s21_vector_t w[2] = {0};
+  s21_fill_sym(&A, n, 1);
+  ck_assert_int_eq(s21_eigen_sym(&A, &w[0], &V[0]), OK);
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.threads = 3, t.threaded_flops = 0;
+  s21_tuning_set(&t);
+  ck_assert_int_eq(s21_eigen_sym(&A, &w[1], &V[1]), OK);
+  s21_tuning_set(NULL);
+  FOR(n) ck_assert_double_eq(w[0].data[i], w[1].data[i]);
+  FORS(n, n) ck_assert_double_eq(V[0].matrix[i][j], V[1].matrix[i][j]);
+  s21_remove_matrix(&A);
+  FOR(2) s21_remove_matrix(&V[i]), s21_remove_vector(&w[i]);
+}
+END_TEST
+
+START_TEST(s21_eigen_4) {
+  // known spectra and errors
+  matrix_t A = {0};
+  matrix_t V = {0};
+  s21_vector_t w = {0};
+  s21_create_matrix(3, 3, &A);
+  A.matrix[0][0] = 3, A.matrix[1][1] = -1, A.matrix[2][2] = 2;
+  ck_assert_int_eq(s21_eigen_sym(&A, &w, &V), OK);
+  ck_assert_double_eq(w.data[0], -1);
+  ck_assert_double_eq(w.data[1], 2);
+  ck_assert_double_eq(w.data[2], 3);
+  ck_assert_double_eq(fabs(V.matrix[1][0]), 1);
+  s21_remove_matrix(&V);
+  s21_remove_vector(&w);
+  A.matrix[2][2] = 0, A.matrix[0][0] = 2, A.matrix[1][1] = 2;
+  A.matrix[1][0] = 1;  // [[2 1] [1 2]] (+) [0]
+  ck_assert_int_eq(s21_eigen_sym(&A, &w, NULL), OK);
+  ck_assert_double_eq_tol(w.data[0], 0, 1e-15);
+  ck_assert_double_eq_tol(w.data[1], 1, 1e-15);
+  ck_assert_double_eq_tol(w.data[2], 3, 1e-15);
+  s21_remove_vector(&w);
+  s21_remove_matrix(&A);
+  s21_create_matrix(1, 1, &A);
+  A.matrix[0][0] = 5;
+  ck_assert_int_eq(s21_eigen_sym(&A, &w, &V), OK);
+  ck_assert_double_eq(w.data[0], 5);
+  ck_assert_double_eq(V.matrix[0][0], 1);
+  s21_remove_matrix(&V);
+  s21_remove_vector(&w);
+  s21_remove_matrix(&A);
+  s21_create_matrix(2, 3, &A);
+  ck_assert_int_eq(s21_eigen_sym(&A, &w, NULL), ERR_CALC);
+  ck_assert_int_eq(s21_eigen_sym(&A, NULL, NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_eigen_sym(NULL, &w, NULL), ERR_FAIL);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+Suite *suite_eigen(void) {
+  Suite *suite = suite_create("s21_eigen_sym");
+  TCase *tc_core = tcase_create("core_of_eigen_sym");
+  tcase_add_loop_test(tc_core, s21_eigen_1, 0, 20);
+  tcase_add_loop_test(tc_core, s21_eigen_2, 0, 6);
+  tcase_add_loop_test(tc_core, s21_eigen_3, 0, 2);
+  tcase_add_test(tc_core, s21_eigen_4);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+// || U diag(S) V^T - A ||_max
+static double s21_svd_residual(matrix_t *A, matrix_t *U, s21_vector_t *S,
+                               matrix_t *V) {
+  double worst = 0;
+  FORS(A->rows, A->columns) {
+    double r = -A->matrix[i][j];
+    for (int p = 0; p < S->size; p++)
+      r += U->matrix[i][p] * S->data[p] * V->matrix[j][p];
+    worst = fmax(worst, fabs(r));
+  }
+  return worst;
+}
+
+START_TEST(s21_svd_1) {
+  // tall, wide and square: reconstruction, orthonormal U and V, order
+  const int m = rand() % 30 + 1, n = rand() % 30 + 1, k = m < n ? m : n;
+  matrix_t A = {0};
+  matrix_t U = {0};
+  matrix_t V = {0};
+  s21_vector_t S = {0};
+  s21_create_matrix(m, n, &A);
+  FORS(m, n) A.matrix[i][j] = get_rand(-10, 10);
+  ck_assert_int_eq(s21_svd(&A, &U, &S, &V), OK);
+  ck_assert_int_eq(S.size, k);
+  ck_assert_int_eq(U.rows, m);
+  ck_assert_int_eq(U.columns, k);
+  ck_assert_int_eq(V.rows, n);
+  ck_assert_int_eq(V.columns, k);
+  ck_assert(s21_svd_residual(&A, &U, &S, &V) < 1e-10);
+  FOR(k) {
+    if (i) ck_assert(S.data[i - 1] >= S.data[i]);
+    for (int p = 0; p < k; p++) {
+      double uu = 0, vv = 0;
+      for (int r = 0; r < m; r++) uu += U.matrix[r][i] * U.matrix[r][p];
+      for (int r = 0; r < n; r++) vv += V.matrix[r][i] * V.matrix[r][p];
+      ck_assert_double_eq_tol(uu, i == p, 1e-12);
+      ck_assert_double_eq_tol(vv, i == p, 1e-12);
+    }
+  }
+  double fro = 0, sum = 0;
+  s21_norm(&A, S21_NORM_FRO, &fro);
+  FOR(k) sum += S.data[i] * S.data[i];
+  ck_assert_double_eq_tol(sqrt(sum), fro, 1e-10);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&U);
+  s21_remove_matrix(&V);
+  s21_remove_vector(&S);
+}
+END_TEST
+
+START_TEST(s21_svd_2) {
+  // rank-deficient: zero tail of S, pinv satisfies the Penrose equations
+  const int m = rand() % 20 + 4, n = rand() % 20 + 4, r = 2;
+  matrix_t X = {0};
+  matrix_t Y = {0};
+  matrix_t A = {0};
+  matrix_t P = {0};
+  matrix_t AP = {0};
+  matrix_t APA = {0};
+  matrix_t PA = {0};
+  matrix_t PAP = {0};
+  s21_vector_t S = {0};
+  s21_create_matrix(m, r, &X);
+  s21_create_matrix(r, n, &Y);
+  FORS(m, r) X.matrix[i][j] = get_rand(-5, 5);
+  FORS(r, n) Y.matrix[i][j] = get_rand(-5, 5);
+  s21_mult_matrix(&X, &Y, &A);
+  ck_assert_int_eq(s21_svd(&A, NULL, &S, NULL), OK);
+  for (int i = r; i < S.size; i++) ck_assert(S.data[i] < 1e-12 * S.data[0]);
+  ck_assert_int_eq(s21_pinv(&A, -1, &P), OK);
+  ck_assert_int_eq(P.rows, n);
+  ck_assert_int_eq(P.columns, m);
+  s21_mult_matrix(&A, &P, &AP);
+  s21_mult_matrix(&AP, &A, &APA);
+  s21_mult_matrix(&P, &A, &PA);
+  s21_mult_matrix(&PA, &P, &PAP);
+  FORS(m, n) ck_assert_double_eq_tol(APA.matrix[i][j], A.matrix[i][j], 1e-9);
+  FORS(n, m) ck_assert_double_eq_tol(PAP.matrix[i][j], P.matrix[i][j], 1e-9);
+  FORS(m, m) ck_assert_double_eq_tol(AP.matrix[i][j], AP.matrix[j][i], 1e-9);
+  FORS(n, n) ck_assert_double_eq_tol(PA.matrix[i][j], PA.matrix[j][i], 1e-9);
+  matrix_t *all[] = {&X, &Y, &A, &P, &AP, &APA, &PA, &PAP};
+  FOR(8) s21_remove_matrix(all[i]);
+  s21_remove_vector(&S);
+}
+END_TEST
+
+START_TEST(s21_svd_3) {
+  // pinv of an invertible matrix is its inverse; thread count is invisible
+  const int n = 40 + _i * 25;
+  matrix_t A = {0};
+  matrix_t P = {0};
+  matrix_t inv = {0};
+  matrix_t U[2] = {0};
+  s21_vector_t S[2] = {0};
+  s21_create_matrix(n, n + 3, &A);
+  FORS(n, n + 3) A.matrix[i][j] = get_rand(-10, 10);
+  ck_assert_int_eq(s21_svd(&A, &U[0], &S[0], NULL), OK);
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.threads = 3, t.threaded_flops = 0;
+  s21_tuning_set(&t);
+  ck_assert_int_eq(s21_svd(&A, &U[1], &S[1], NULL), OK);
+  s21_tuning_set(NULL);
+  FOR(n) ck_assert_double_eq(S[0].data[i], S[1].data[i]);
+  FORS(n, n) ck_assert_double_eq(U[0].matrix[i][j], U[1].matrix[i][j]);
+  matrix_t square = {0};
+  s21_matrix_view(&A, 0, 0, n, n, &square);
+  ck_assert_int_eq(s21_pinv(&square, 0, &P), OK);
+  s21_lu_inverse(&square, &inv);
+  FORS(n, n) ck_assert_double_eq_tol(P.matrix[i][j], inv.matrix[i][j], 1e-9);
+  s21_remove_matrix(&square);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&P);
+  s21_remove_matrix(&inv);
+  FOR(2) s21_remove_matrix(&U[i]), s21_remove_vector(&S[i]);
+}
+END_TEST
+
+START_TEST(s21_svd_4) {
+  // randomized top-k recovers a rank-k matrix and the full SVD's values
+  const int m = 60 + rand() % 40, n = 30 + rand() % 40, k = _i % 5 + 1;
+  matrix_t X = {0};
+  matrix_t Y = {0};
+  matrix_t A = {0};
+  matrix_t U = {0};
+  matrix_t V = {0};
+  s21_vector_t S = {0};
+  s21_vector_t full = {0};
+  s21_create_matrix(m, k, &X);
+  s21_create_matrix(k, n, &Y);
+  FORS(m, k) X.matrix[i][j] = get_rand(-5, 5);
+  FORS(k, n) Y.matrix[i][j] = get_rand(-5, 5);
+  s21_mult_matrix(&X, &Y, &A);
+  ck_assert_int_eq(s21_svd_top(&A, k, &U, &S, &V), OK);
+  ck_assert_int_eq(s21_svd(&A, NULL, &full, NULL), OK);
+  ck_assert_int_eq(S.size, k);
+  FOR(k) ck_assert_double_eq_tol(S.data[i] / full.data[i], 1, 1e-10);
+  ck_assert(s21_svd_residual(&A, &U, &S, &V) < 1e-9 * full.data[0]);
+  s21_remove_vector(&S);
+  s21_remove_matrix(&U);
+  s21_remove_matrix(&V);
+  ck_assert_int_eq(s21_svd_top(&A, k, NULL, &S, NULL), OK);
+  ck_assert_int_eq(s21_svd_top(&A, 0, NULL, &S, NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_svd_top(&A, n + 1, NULL, &S, NULL), ERR_CALC);
+  ck_assert_int_eq(s21_svd(NULL, NULL, &S, NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_pinv(&A, 0, NULL), ERR_FAIL);
+  s21_remove_matrix(&X);
+  s21_remove_matrix(&Y);
+  s21_remove_matrix(&A);
+  s21_remove_vector(&S);
+  s21_remove_vector(&full);
+}
+END_TEST
+
+Suite *suite_svd(void) {
+  Suite *suite = suite_create("s21_svd");
+  TCase *tc_core = tcase_create("core_of_svd");
+  tcase_add_loop_test(tc_core, s21_svd_1, 0, 20);
+  tcase_add_loop_test(tc_core, s21_svd_2, 0, 8);
+  tcase_add_loop_test(tc_core, s21_svd_3, 0, 2);
+  tcase_add_loop_test(tc_core, s21_svd_4, 0, 5);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+static void s21_io_path(char *path, int i) {
+  snprintf(path, 64, "/tmp/s21_io_%d_%d.txt", (int)getpid(), i);
+}
+
+START_TEST(s21_io_1) {
+  // every format reads back bit for bit, awkward values included
+  const int m = rand() % 12 + 1, n = rand() % 12 + 1, format = _i % 3;
+  char path[64];
+  s21_io_path(path, _i);
+  matrix_t A = {0};
+  matrix_t B = {0};
+  s21_create_matrix(m, n, &A);
+  FORS(m, n) A.matrix[i][j] = get_rand(-1e3, 1e3) * pow(10, rand() % 41 - 20);
+  A.matrix[0][0] = 1.0 / 3, A.matrix[m - 1][n - 1] = 0.1;
+  if (format != S21_FMT_MM_COORD) A.matrix[m - 1][0] = -0.0;
+  if (m * n > 2) A.matrix[0][n - 1] = 0;
+  if (n > 1) A.matrix[0][1] = 5e-324;
+  ck_assert_int_eq(s21_save_matrix(path, &A, format), OK);
+  ck_assert_int_eq(s21_load_matrix(path, &B), OK);
+  ck_assert_int_eq(B.rows, m);
+  ck_assert_int_eq(B.columns, n);
+  FORS(m, n) ck_assert(memcmp(&A.matrix[i][j], &B.matrix[i][j], 8) == 0);
+  remove(path);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+}
+END_TEST
+
+START_TEST(s21_io_2) {
+  // shortest round-trip text, and the layouts each format writes
+  char path[64], text[512] = {0};
+  s21_io_path(path, 100);
+  matrix_t A = {0};
+  s21_create_matrix(2, 2, &A);
+  A.matrix[0][0] = 0.1, A.matrix[0][1] = 100;
+  A.matrix[1][0] = 0, A.matrix[1][1] = 1.0 / 3;
+  const char *want[] = {
+      "0.1,100\n0,0.3333333333333333\n",
+      "%%MatrixMarket matrix array real general\n2 2\n0.1\n0\n100\n"
+      "0.3333333333333333\n",
+      "%%MatrixMarket matrix coordinate real general\n2 2 3\n1 1 0.1\n"
+      "1 2 100\n2 2 0.3333333333333333\n"};
+  for (int format = 0; format < 3; format++) {
+    ck_assert_int_eq(s21_save_matrix(path, &A, format), OK);
+    FILE *f = fopen(path, "r");
+    size_t len = fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    text[len] = '\0';
+    ck_assert_str_eq(text, want[format]);
+  }
+  ck_assert_int_eq(s21_save_matrix(path, &A, 3), ERR_FAIL);
+  ck_assert_int_eq(s21_save_matrix(NULL, &A, 0), ERR_FAIL);
+  ck_assert_int_eq(s21_save_matrix("/nonexistent/dir/m.csv", &A, 0), ERR_FAIL);
+  ck_assert_int_eq(s21_load_matrix("/nonexistent/dir/m.csv", &A), ERR_FAIL);
+  remove(path);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_io_3) {
+  // spacing, CRLF, blank lines and comments; symmetric, skew and pattern
+  matrix_t A = {0};
+  ck_assert_int_eq(s21_parse_matrix("\n 1, -2.5e1 ,3\r\n\n4,5,  6 \n", &A),
+                   OK);
+  ck_assert_int_eq(A.rows, 2);
+  ck_assert_int_eq(A.columns, 3);
+  ck_assert_double_eq(A.matrix[0][1], -25);
+  ck_assert_double_eq(A.matrix[1][2], 6);
+  s21_remove_matrix(&A);
+  ck_assert_int_eq(
+      s21_parse_matrix("%%MatrixMarket matrix coordinate real symmetric\n"
+                       "% comment\n3 3 3\n1 1 2\n3 1 -1\n\n2 2 .5\n",
+                       &A),
+      OK);
+  ck_assert_double_eq(A.matrix[0][2], -1);
+  ck_assert_double_eq(A.matrix[2][0], -1);
+  ck_assert_double_eq(A.matrix[1][1], 0.5);
+  ck_assert_double_eq(A.matrix[2][2], 0);
+  s21_remove_matrix(&A);
+  ck_assert_int_eq(
+      s21_parse_matrix("%%MatrixMarket matrix coordinate pattern "
+                       "skew-symmetric\n2 2 1\n2 1\n",
+                       &A),
+      OK);
+  ck_assert_double_eq(A.matrix[1][0], 1);
+  ck_assert_double_eq(A.matrix[0][1], -1);
+  s21_remove_matrix(&A);
+  ck_assert_int_eq(
+      s21_parse_matrix("%%matrixmarket Matrix Array integer symmetric\n"
+                       "3 3\n1\n2\n3\n4\n5\n6\n",
+                       &A),
+      OK);
+  double want[3][3] = {{1, 2, 3}, {2, 4, 5}, {3, 5, 6}};
+  FORS(3, 3) ck_assert_double_eq(A.matrix[i][j], want[i][j]);
+  s21_remove_matrix(&A);
+  ck_assert_int_eq(
+      s21_parse_matrix("%%MatrixMarket matrix array real skew-symmetric\n"
+                       "3 3\n1\n2\n3\n",
+                       &A),
+      OK);
+  double skew[3][3] = {{0, -1, -2}, {1, 0, -3}, {2, 3, 0}};
+  FORS(3, 3) ck_assert_double_eq(A.matrix[i][j], skew[i][j]);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(s21_io_4) {
+  // malformed text fails without leaving a matrix behind
+  const char *bad[] = {
+      "",
+      "\n\n",
+      "1,2\n3\n",
+      "1,2\n3,4,5\n",
+      "1,x\n",
+      "1,2,\n",
+      "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n",
+      "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n",
+      "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1\n",
+      "%%MatrixMarket matrix coordinate complex general\n1 1 1\n1 1 1 0\n",
+      "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n",
+      "%%MatrixMarket matrix array pattern general\n1 1\n1\n",
+      "%%MatrixMarket matrix array real symmetric\n2 3\n1\n2\n3\n",
+      "%%MatrixMarket vector array real general\n1 1\n1\n",
+      "%%MatrixMarket matrix\n1 1\n1\n"};
+  matrix_t A = {0};
+  for (size_t k = 0; k < sizeof(bad) / sizeof(*bad); k++) {
+    ck_assert_int_eq(s21_parse_matrix(bad[k], &A), ERR_FAIL);
+    ck_assert_ptr_null(A.matrix);
+  }
+  ck_assert_int_eq(s21_parse_matrix(NULL, &A), ERR_FAIL);
+  ck_assert_int_eq(s21_parse_matrix("1\n", NULL), ERR_FAIL);
+}
+END_TEST
+
+START_TEST(s21_io_5) {
+  // a text past the threading cutoff parses the same on several threads
+  const int m = 3000 + _i, n = 40;
+  char path[64];
+  s21_io_path(path, 200 + _i);
+  matrix_t A = {0};
+  matrix_t B = {0};
+  s21_create_matrix(m, n, &A);
+  FORS(m, n) A.matrix[i][j] = get_rand(-1, 1);
+  if (_i) A.matrix[m / 2][n / 2] = 0x1p-1070;
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.threads = 3;
+  s21_tuning_set(&t);
+  ck_assert_int_eq(s21_save_matrix(path, &A, _i ? 1 : 0), OK);
+  ck_assert_int_eq(s21_load_matrix(path, &B), OK);
+  ck_assert_int_eq(s21_eq_matrix(&A, &B), SUCCESS);
+  FORS(m, n) ck_assert(A.matrix[i][j] == B.matrix[i][j]);
+  s21_tuning_set(NULL);
+  remove(path);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+}
+END_TEST
+
+Suite *suite_io(void) {
+  Suite *suite = suite_create("s21_io");
+  TCase *tc_core = tcase_create("core_of_io");
+  tcase_add_loop_test(tc_core, s21_io_1, 0, 30);
+  tcase_add_test(tc_core, s21_io_2);
+  tcase_add_test(tc_core, s21_io_3);
+  tcase_add_test(tc_core, s21_io_4);
+  tcase_add_loop_test(tc_core, s21_io_5, 0, 2);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_frozen_1) {
+  // the flag sticks, views inherit it and writers refuse it
+  matrix_t A = {0};
+  matrix_t V = {0};
+  s21_create_matrix(4, 3, &A);
+  ck_assert_int_eq(s21_is_frozen(&A), 0);
+  ck_assert_int_eq(s21_freeze(&A), OK);
+  ck_assert_int_eq(s21_is_frozen(&A), 1);
+  ck_assert_int_eq(s21_matrix_view(&A, 1, 1, 2, 2, &V), OK);
+  ck_assert_int_eq(s21_is_frozen(&V), 1);
+  double rows[6] = {1, 2, 3, 4, 5, 6};
+  s21_cursor_t c = {&A, 0};
+  ck_assert_int_eq(s21_matrix_writer(&c, rows, 2, 3), ERR_FAIL);
+  FORS(4, 3) ck_assert_double_eq(A.matrix[i][j], 0);
+  ck_assert_int_eq(s21_freeze(NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_is_frozen(NULL), 0);
+  s21_remove_matrix(&V);
+  s21_remove_matrix(&A);
+  ck_assert_int_eq(s21_freeze(&A), ERR_FAIL);
+}
+END_TEST
+
+#define READERS 4
+
+typedef struct {
+  matrix_t *A;
+  matrix_t product, inverse;
+  s21_vector_t values;
+  double det, norm;
+  int status;
+} s21_reader_t;
+
+// a mix of read-only entry points, each on threads of its own
+static void *s21_frozen_read(void *arg) {
+  s21_reader_t *r = arg;
+  r->status = s21_mult_matrix(r->A, r->A, &r->product);
+  r->status |= s21_lu_inverse(r->A, &r->inverse);
+  r->status |= s21_lu_determinant(r->A, &r->det);
+  r->status |= s21_norm(r->A, S21_NORM_FRO, &r->norm);
+  r->status |= s21_eigen_sym(r->A, &r->values, NULL);
+  return NULL;
+}
+
+static void s21_reader_free(s21_reader_t *r) {
+  s21_remove_matrix(&r->product);
+  s21_remove_matrix(&r->inverse);
+  s21_remove_vector(&r->values);
+}
+
+START_TEST(s21_frozen_2) {
+  // concurrent readers of one frozen matrix agree bit for bit with a
+  // lone reader
+  const int n = 40 + _i * 60;
+  matrix_t A = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = get_rand(-1, 1) + (i == j) * n;
+  s21_freeze(&A);
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.threads = 2 + _i, t.threaded_flops = 0;
+  s21_tuning_set(&t);
+  s21_reader_t lone = {.A = &A}, r[READERS];
+  s21_frozen_read(&lone);
+  ck_assert_int_eq(lone.status, OK);
+  pthread_t tid[READERS];
+  FOR(READERS) {
+    r[i] = (s21_reader_t){.A = &A};
+    ck_assert_int_eq(pthread_create(&tid[i], NULL, s21_frozen_read, &r[i]),
+                     0);
+  }
+  FOR(READERS) pthread_join(tid[i], NULL);
+  for (int k = 0; k < READERS; k++) {
+    ck_assert_int_eq(r[k].status, OK);
+    ck_assert(r[k].det == lone.det && r[k].norm == lone.norm);
+    FORS(n, n) {
+      ck_assert(r[k].product.matrix[i][j] == lone.product.matrix[i][j]);
+      ck_assert(r[k].inverse.matrix[i][j] == lone.inverse.matrix[i][j]);
+    }
+    FOR(n) ck_assert(r[k].values.data[i] == lone.values.data[i]);
+    s21_reader_free(&r[k]);
+  }
+  s21_tuning_set(NULL);
+  s21_reader_free(&lone);
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+Suite *suite_frozen(void) {
+  Suite *suite = suite_create("s21_frozen");
+  TCase *tc_core = tcase_create("core_of_frozen");
+  tcase_add_test(tc_core, s21_frozen_1);
+  tcase_add_loop_test(tc_core, s21_frozen_2, 0, 2);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_share_1) {
+  // clones share the rows until detached, the last handle frees them
+  const int m = rand() % 20 + 1, n = rand() % 20 + 1;
+  const int flags = _i % 2 ? S21_ALLOC_ALIGNED : S21_ALLOC_DEFAULT;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t C = {0};
+  s21_create_matrix_ex(m, n, flags, &A);
+  FORS(m, n) A.matrix[i][j] = get_rand(-10, 10);
+  ck_assert_int_eq(s21_share_count(&A), 1);
+  ck_assert_int_eq(s21_clone_matrix(&A, &B), OK);
+  ck_assert_int_eq(s21_clone_matrix(&B, &C), OK);
+  ck_assert_ptr_eq(A.matrix, B.matrix);
+  ck_assert_ptr_eq(A.matrix, C.matrix);
+  ck_assert_int_eq(s21_share_count(&A), 3);
+  ck_assert_int_eq(s21_detach_matrix(&B), OK);
+  ck_assert_ptr_ne(A.matrix, B.matrix);
+  ck_assert_int_eq(B.flags, flags);
+  ck_assert_int_eq(s21_share_count(&A), 2);
+  ck_assert_int_eq(s21_share_count(&B), 1);
+  ck_assert_int_eq(s21_eq_matrix(&A, &B), SUCCESS);
+  B.matrix[m - 1][n - 1] = A.matrix[m - 1][n - 1] + 1;
+  ck_assert_double_eq(C.matrix[m - 1][n - 1], A.matrix[m - 1][n - 1]);
+  s21_remove_matrix(&A);
+  ck_assert_ptr_null(A.matrix);
+  ck_assert_int_eq(s21_share_count(&C), 1);
+  double **rows = C.matrix;
+  ck_assert_int_eq(s21_detach_matrix(&C), OK);
+  ck_assert_ptr_eq(C.matrix, rows);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+}
+END_TEST
+
+START_TEST(s21_share_2) {
+  // views clone by copy, frozen data detaches into a writable copy and
+  // the stream writer detaches before it writes
+  matrix_t A = {0};
+  matrix_t V = {0};
+  matrix_t B = {0};
+  matrix_t F = {0};
+  s21_create_matrix(3, 3, &A);
+  FORS(3, 3) A.matrix[i][j] = i * 3 + j;
+  s21_matrix_view(&A, 1, 1, 2, 2, &V);
+  ck_assert_int_eq(s21_clone_matrix(&V, &B), OK);
+  ck_assert_int_eq(s21_share_count(&A), 1);
+  ck_assert_int_eq(B.flags & S21_M_VIEW, 0);
+  ck_assert_double_eq(B.matrix[1][1], 8);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&V);
+  ck_assert_int_eq(s21_clone_matrix(&A, &B), OK);
+  double rows[3] = {-1, -2, -3};
+  s21_cursor_t c = {&B, 0};
+  ck_assert_int_eq(s21_matrix_writer(&c, rows, 1, 3), OK);
+  ck_assert_double_eq(B.matrix[0][2], -3);
+  ck_assert_double_eq(A.matrix[0][2], 2);
+  s21_freeze(&A);
+  ck_assert_int_eq(s21_clone_matrix(&A, &F), OK);
+  ck_assert_int_eq(s21_is_frozen(&F), 1);
+  s21_remove_matrix(&A);
+  ck_assert_int_eq(s21_detach_matrix(&F), OK);
+  ck_assert_int_eq(s21_is_frozen(&F), 0);
+  ck_assert_double_eq(F.matrix[2][2], 8);
+  ck_assert_int_eq(s21_clone_matrix(NULL, &B), ERR_FAIL);
+  ck_assert_int_eq(s21_detach_matrix(NULL), ERR_FAIL);
+  ck_assert_int_eq(s21_share_count(NULL), 0);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&F);
+}
+END_TEST
+
+#define HANDLES 6
+
+typedef struct {
+  matrix_t m, *from;
+  double sum;
+  int status;
+} s21_handle_t;
+
+static void *s21_share_worker(void *arg) {
+  s21_handle_t *h = arg;
+  FORS(h->m.rows, h->m.columns) h->sum += h->m.matrix[i][j];
+  return NULL;
+}
+
+// every thread reads its clone; odd ones detach and write, even ones
+// drop their handle while the others still read
+static void *s21_share_mutate(void *arg) {
+  s21_handle_t *h = arg;
+  s21_share_worker(h);
+  h->status = s21_detach_matrix(&h->m);
+  if (!h->status) FORS(h->m.rows, h->m.columns) h->m.matrix[i][j] = -1;
+  return NULL;
+}
+
+static void *s21_share_drop(void *arg) {
+  s21_handle_t *h = arg;
+  s21_share_worker(h);
+  s21_remove_matrix(&h->m);
+  return NULL;
+}
+
+START_TEST(s21_share_3) {
+  // handles cloned on one thread and released on many leave the source
+  // intact with an exact count
+  const int n = 64;
+  matrix_t A = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = i - j;
+  s21_handle_t h[HANDLES] = {0};
+  pthread_t tid[HANDLES];
+  FOR(HANDLES) ck_assert_int_eq(s21_clone_matrix(&A, &h[i].m), OK);
+  ck_assert_int_eq(s21_share_count(&A), HANDLES + 1);
+  FOR(HANDLES)
+  pthread_create(&tid[i], NULL, i % 2 ? s21_share_mutate : s21_share_drop,
+                 &h[i]);
+  FOR(HANDLES) pthread_join(tid[i], NULL);
+  ck_assert_int_eq(s21_share_count(&A), 1);
+  FORS(n, n) ck_assert_double_eq(A.matrix[i][j], i - j);
+  FOR(HANDLES) {
+    ck_assert_double_eq(h[i].sum, 0);
+    ck_assert_int_eq(h[i].status, OK);
+    if (i % 2) ck_assert_double_eq(h[i].m.matrix[n - 1][0], -1);
+    s21_remove_matrix(&h[i].m);
+  }
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+// clones a matrix the other threads are cloning too, then goes private
+static void *s21_share_clone(void *arg) {
+  s21_handle_t *h = arg;
+  h->status = s21_clone_matrix(h->from, &h->m);
+  if (!h->status) s21_share_mutate(h);
+  return NULL;
+}
+
+START_TEST(s21_share_4) {
+  // a frozen matrix, never cloned before, cloned on many threads at once:
+  // they race to install the count and all end up on the same one
+  const int n = 64;
+  matrix_t A = {0};
+  s21_create_matrix(n, n, &A);
+  FORS(n, n) A.matrix[i][j] = i - j;
+  s21_freeze(&A);
+  s21_handle_t h[HANDLES] = {0};
+  pthread_t tid[HANDLES];
+  FOR(HANDLES) h[i].from = &A;
+  FOR(HANDLES) pthread_create(&tid[i], NULL, s21_share_clone, &h[i]);
+  FOR(HANDLES) pthread_join(tid[i], NULL);
+  ck_assert_int_eq(s21_share_count(&A), 1);
+  ck_assert(s21_is_frozen(&A));
+  FORS(n, n) ck_assert_double_eq(A.matrix[i][j], i - j);
+  FOR(HANDLES) {
+    ck_assert_int_eq(h[i].status, OK);
+    ck_assert_double_eq(h[i].sum, 0);
+    ck_assert_double_eq(h[i].m.matrix[n - 1][0], -1);
+    ck_assert_int_eq(s21_share_count(&h[i].m), 1);
+    s21_remove_matrix(&h[i].m);
+  }
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+Suite *suite_share(void) {
+  Suite *suite = suite_create("s21_share");
+  TCase *tc_core = tcase_create("core_of_share");
+  tcase_add_loop_test(tc_core, s21_share_1, 0, 10);
+  tcase_add_test(tc_core, s21_share_2);
+  tcase_add_loop_test(tc_core, s21_share_3, 0, 5);
+  tcase_add_loop_test(tc_core, s21_share_4, 0, 20);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
+START_TEST(s21_product_1) {
+  // element-wise product and quotient against the plain loops
+  const int m = rand() % 30 + 1, n = rand() % 30 + 1;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t H = {0};
+  matrix_t Q = {0};
+  s21_create_matrix(m, n, &A);
+  s21_create_matrix(m, n, &B);
+  FORS(m, n) {
+    A.matrix[i][j] = get_rand(-100, 100);
+    B.matrix[i][j] = get_rand(0.5, 2) * (rand() % 2 ? 1 : -1);
+  }
+  ck_assert_int_eq(s21_hadamard(&A, &B, &H), OK);
+  ck_assert_int_eq(s21_hadamard_div(&A, &B, &Q), OK);
+  FORS(m, n) {
+    ck_assert(H.matrix[i][j] == A.matrix[i][j] * B.matrix[i][j]);
+    ck_assert(Q.matrix[i][j] == A.matrix[i][j] / B.matrix[i][j]);
+  }
+  s21_remove_matrix(&H);
+  s21_remove_matrix(&Q);
+  B.matrix[m - 1][n - 1] = 0;
+  ck_assert_int_eq(s21_hadamard_div(&A, &B, &Q), ERR_CALC);
+  ck_assert_ptr_null(Q.matrix);
+  s21_remove_matrix(&B);
+  s21_create_matrix(m + 1, n, &B);
+  ck_assert_int_eq(s21_hadamard(&A, &B, &H), ERR_CALC);
+  ck_assert_int_eq(s21_hadamard_div(&A, &B, &H), ERR_CALC);
+  ck_assert_int_eq(s21_hadamard(&A, NULL, &H), ERR_FAIL);
+  ck_assert_int_eq(s21_hadamard(&A, &A, NULL), ERR_FAIL);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+}
+END_TEST
+
+START_TEST(s21_product_2) {
+  // A (x) B entry by entry, threaded or not, and x y^T
+  const int ma = rand() % 6 + 1, na = rand() % 6 + 1;
+  const int mb = rand() % 6 + 1, nb = rand() % 6 + 1;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t K = {0};
+  s21_create_matrix(ma, na, &A);
+  s21_create_matrix(mb, nb, &B);
+  FORS(ma, na) A.matrix[i][j] = get_rand(-10, 10);
+  FORS(mb, nb) B.matrix[i][j] = get_rand(-10, 10);
+  s21_tuning_t t;
+  s21_tuning_defaults(&t);
+  t.threads = _i % 3 + 1, t.threaded_flops = 0;
+  s21_tuning_set(&t);
+  ck_assert_int_eq(s21_kron(&A, &B, &K), OK);
+  s21_tuning_set(NULL);
+  ck_assert_int_eq(K.rows, ma * mb);
+  ck_assert_int_eq(K.columns, na * nb);
+  FORS(ma, na) for (int k = 0; k < mb; k++) for (int l = 0; l < nb; l++)
+    ck_assert(K.matrix[i * mb + k][j * nb + l] ==
+              A.matrix[i][j] * B.matrix[k][l]);
+  s21_vector_t x = {0};
+  s21_vector_t y = {0};
+  matrix_t O = {0};
+  s21_create_vector(ma, &x);
+  s21_create_vector(nb, &y);
+  FOR(ma) x.data[i] = get_rand(-5, 5);
+  FOR(nb) y.data[i] = get_rand(-5, 5);
+  ck_assert_int_eq(s21_outer(&x, &y, &O), OK);
+  FORS(ma, nb) ck_assert(O.matrix[i][j] == x.data[i] * y.data[j]);
+  ck_assert_int_eq(s21_outer(&x, NULL, &O), ERR_FAIL);
+  ck_assert_int_eq(s21_kron(&A, NULL, &K), ERR_FAIL);
+  s21_remove_vector(&x);
+  s21_remove_vector(&y);
+  s21_remove_matrix(&O);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&K);
+}
+END_TEST
+
+START_TEST(s21_product_3) {
+  // the lazy apply matches the materialized product times x
+  const int ma = rand() % 12 + 1, na = rand() % 12 + 1;
+  const int mb = rand() % 12 + 1, nb = rand() % 12 + 1;
+  matrix_t A = {0};
+  matrix_t B = {0};
+  matrix_t K = {0};
+  s21_vector_t x = {0};
+  s21_vector_t y = {0};
+  s21_vector_t want = {0};
+  s21_create_matrix(ma, na, &A);
+  s21_create_matrix(mb, nb, &B);
+  FORS(ma, na) A.matrix[i][j] = get_rand(-1, 1);
+  FORS(mb, nb) B.matrix[i][j] = get_rand(-1, 1);
+  s21_create_vector(na * nb, &x);
+  s21_create_vector(ma * mb, &y);
+  s21_create_vector(ma * mb, &want);
+  FOR(na * nb) x.data[i] = get_rand(-1, 1);
+  ck_assert_int_eq(s21_kron_apply(&A, &B, &x, &y), OK);
+  s21_kron(&A, &B, &K);
+  s21_gemv(S21_NO_TRANS, 1, &K, &x, 0, &want);
+  FOR(ma * mb) ck_assert_double_eq_tol(y.data[i], want.data[i], 1e-12);
+  ck_assert_int_eq(s21_kron_apply(&A, &B, &x, &x), ERR_CALC);
+  if (ma * mb != na * nb)
+    ck_assert_int_eq(s21_kron_apply(&A, &B, &y, &x), ERR_CALC);
+  ck_assert_int_eq(s21_kron_apply(&A, &B, NULL, &y), ERR_FAIL);
+  s21_remove_vector(&x);
+  s21_remove_vector(&y);
+  s21_remove_vector(&want);
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&K);
+}
+END_TEST
+
+Suite *suite_product(void) {
+  Suite *suite = suite_create("s21_product");
+  TCase *tc_core = tcase_create("core_of_product");
+  tcase_add_loop_test(tc_core, s21_product_1, 0, 20);
+  tcase_add_loop_test(tc_core, s21_product_2, 0, 20);
+  tcase_add_loop_test(tc_core, s21_product_3, 0, 20);
+  suite_add_tcase(suite, tc_core);
+
+  return suite;
+}
+
 void run_tests(void) {
   Suite *list_cases[] = {
 
@@ -1237,6 +3940,30 @@ void run_tests(void) {
       suite_determinant(),
       suite_calc_complements(),
       suite_inverse_matrix(),
+      suite_cholesky(),
+      suite_qr(),
+      suite_cofactors_mt(),
+      suite_stats(),
+      suite_stream(),
+      suite_async(),
+      suite_create_matrix_ex(),
+      suite_create_matrix_aligned(),
+      suite_matrix_view(),
+      suite_wrap_matrix(),
+      suite_cancel(),
+      suite_plan(),
+      suite_autotune(),
+      suite_accumulate(),
+      suite_matrix_pow(),
+      suite_band(),
+      suite_gemv(),
+      suite_reduce(),
+      suite_eigen(),
+      suite_svd(),
+      suite_io(),
+      suite_frozen(),
+      suite_share(),
+      suite_product(),
       NULL};
   for (Suite **current_testcase = list_cases; *current_testcase != NULL;
        current_testcase++) {
@@ -0,0 +1,205 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../s21_matrix.h"
+
+// sweeps the planner thresholds on this host and writes the profile the
+// library loads at startup; usage: s21_autotune [--quick] [profile path]
+
+#define REPS 3
+#define MIN_BATCH 2e-3
+
+typedef int (*s21_bench_fn)(matrix_t *A, matrix_t *B);
+
+static double s21_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void s21_fill(matrix_t *A) {
+  FORS(A->rows, A->columns) A->matrix[i][j] = (double)rand() / RAND_MAX - .5;
+}
+
+static int s21_run_mult(matrix_t *A, matrix_t *B) {
+  matrix_t C = {0};
+  int status = s21_mult_matrix(A, B, &C);
+  s21_remove_matrix(&C);
+  return status;
+}
+
+static int s21_run_transpose(matrix_t *A, matrix_t *B) {
+  (void)B;
+  matrix_t T = {0};
+  int status = s21_transpose(A, &T);
+  s21_remove_matrix(&T);
+  return status;
+}
+
+static int s21_run_qr(matrix_t *A, matrix_t *B) {
+  (void)B;
+  matrix_t Q = {0}, R = {0};
+  int status = s21_qr(A, &Q, &R);
+  s21_remove_matrix(&Q);
+  s21_remove_matrix(&R);
+  return status;
+}
+
+static int s21_run_complements(matrix_t *A, matrix_t *B) {
+  (void)B;
+  matrix_t C = {0};
+  int status = s21_calc_complements(A, &C);
+  s21_remove_matrix(&C);
+  return status;
+}
+
+// seconds per call of fn under tuning t on n x n operands: calls are
+// batched until a batch takes MIN_BATCH, the best of REPS batches counts
+static double s21_time(const s21_tuning_t *t, s21_bench_fn fn, int n) {
+  matrix_t A = {0}, B = {0};
+  if (s21_create_matrix(n, n, &A) || s21_create_matrix(n, n, &B)) return 1e30;
+  s21_fill(&A), s21_fill(&B);
+  s21_tuning_set(t);
+  double best = 1e30;
+  for (int r = 0, calls = 1; r < REPS; r++) {
+    double start = s21_now();
+    int status = OK;
+    FOR(calls) status |= fn(&A, &B);
+    double dt = s21_now() - start;
+    if (status) break;
+    if (dt < MIN_BATCH && calls < 1 << 20) {
+      calls *= 2, r--;
+      continue;
+    }
+    if (dt / calls < best) best = dt / calls;
+  }
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  return best;
+}
+
+// the candidate of *field with the lowest time
+static int s21_sweep(s21_tuning_t *t, int *field, const int *values,
+                     int count, s21_bench_fn fn, int n, const char *what) {
+  int best = *field;
+  double best_time = 1e30;
+  FOR(count) {
+    *field = values[i];
+    double dt = s21_time(t, fn, n);
+    printf("  %-16s %6d  %12.1f us\n", what, values[i], dt * 1e6);
+    if (dt < best_time) best_time = dt, best = values[i];
+  }
+  return *field = best;
+}
+
+// largest size where the kernel picked by `small` beats the one of `big`
+static int s21_crossover(const s21_tuning_t *small, const s21_tuning_t *big,
+                         const int *sizes, int count, s21_bench_fn fn,
+                         const char *what) {
+  int last = 0;
+  FOR(count) {
+    double a = s21_time(small, fn, sizes[i]), b = s21_time(big, fn, sizes[i]);
+    printf("  %-16s %6d  %12.1f us vs %12.1f us\n", what, sizes[i], a * 1e6,
+           b * 1e6);
+    if (a > b) break;
+    last = sizes[i];
+  }
+  return last;
+}
+
+static int s21_mkdirs(const char *path) {
+  char dir[512];
+  snprintf(dir, sizeof(dir), "%s", path);
+  for (char *p = dir + 1; *p; p++) {
+    if (*p != '/') continue;
+    *p = '\0';
+    if (mkdir(dir, 0755) && errno != EEXIST) return ERR_FAIL;
+    *p = '/';
+  }
+  return OK;
+}
+
+int main(int argc, char **argv) {
+  int quick = argc > 1 && !strcmp(argv[1], "--quick");
+  const char *out = argc > 1 + quick ? argv[1 + quick] : NULL;
+  char path[512];
+  if (!out) {
+    int n = s21_tuning_path(path, sizeof(path));
+    if (n <= 0 || (size_t)n >= sizeof(path))
+      return fprintf(stderr, "s21_autotune: no cache directory\n"), 1;
+    out = path;
+  }
+  srand(21);
+  int cpus = s21_thread_count(0, 1 << 20);
+  s21_tuning_t t, probe;
+  s21_tuning_defaults(&t);
+
+  // serial tiles first, every other sweep runs with them
+  printf("multiply tile\n");
+  probe = t, probe.small_max = 0, probe.threads = 1;
+  const int blocks[] = {16, 24, 32, 48, 64, 96, 128, 192, 256};
+  t.block = s21_sweep(&probe, &probe.block, blocks, 9, s21_run_mult,
+                      quick ? 192 : 512, "block");
+
+  printf("transpose tile\n");
+  probe = t, probe.small_max = 0;
+  const int tblocks[] = {8, 16, 32, 64, 128};
+  t.transpose_block = s21_sweep(&probe, &probe.transpose_block, tblocks, 5,
+                                s21_run_transpose, quick ? 1024 : 3000,
+                                "transpose_block");
+
+  printf("qr panel\n");
+  probe = t, probe.threads = 1;
+  const int panels[] = {8, 16, 32, 48, 64, 96, 128};
+  t.qr_block = s21_sweep(&probe, &probe.qr_block, panels, 7, s21_run_qr,
+                         quick ? 256 : 768, "qr_block");
+
+  printf("small kernel\n");
+  s21_tuning_t small = t, big = t;
+  small.small_max = 1 << 20, big.small_max = 0, big.threads = 1;
+  const int ssizes[] = {4, 8, 12, 16, 24, 32, 48, 64};
+  t.small_max = s21_crossover(&small, &big, ssizes, 8, s21_run_mult, "mult");
+
+  printf("threads\n");
+  if (cpus > 1) {
+    s21_tuning_t serial = t, threaded = t;
+    serial.threads = 1, threaded.threaded_flops = 0;
+    const int msizes[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+    int n = s21_crossover(&serial, &threaded, msizes, 10, s21_run_mult,
+                          "mult");
+    t.threaded_flops = 2.0 * n * n * n + 1;  // serial still won at n
+    serial.complements_mt_min = 1 << 20, threaded.complements_mt_min = 2;
+    const int csizes[] = {3, 4, 5, 6, 7, 8};
+    t.complements_mt_min = s21_crossover(&serial, &threaded, csizes, 6,
+                                         s21_run_complements, "complements") +
+                           1;
+  } else {
+    printf("  one CPU, threaded cut-overs left at their defaults\n");
+  }
+
+  if (!quick) {
+    printf("strassen\n");
+    s21_tuning_t plain = t, strassen = t;
+    const int leaves[] = {64, 128, 256};
+    strassen.strassen_min = 2;
+    s21_sweep(&strassen, &strassen.strassen_leaf, leaves, 3, s21_run_mult,
+              1024, "strassen_leaf");
+    t.strassen_leaf = strassen.strassen_leaf;
+    plain.strassen_min = 1 << 20;
+    const int psizes[] = {512, 1024, 2048};
+    int last = s21_crossover(&plain, &strassen, psizes, 3, s21_run_mult,
+                             "blocked");
+    t.strassen_min = last == 2048 ? 4096 : (last ? last * 2 : 512);
+  }
+
+  s21_tuning_set(&t);
+  if (s21_mkdirs(out) || s21_tuning_save(out))
+    return fprintf(stderr, "s21_autotune: cannot write %s\n", out), 1;
+  printf("profile written to %s\n", out);
+  return 0;
+}